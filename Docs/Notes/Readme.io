@@ -29,6 +29,8 @@ vismf.usepersistentifstreams  (def:  true)
 vismf.usesynchronousreads     (def:  false)
 vismf.usedynamicsetselection  (def:  true)
 vismf.iobuffersize            (def:  VisMF::IO_Buffer_Size)
+vismf.compressiontolerance    (def:  0, lossless, only for headerversion 5)
+vismf.compressionchunksize    (def:  131072)
 amr.plot_nfiles               (def:  64)
 amr.checkpoint_nfiles         (def:  64)
 amr.mffile_nstreams           (def:  1)
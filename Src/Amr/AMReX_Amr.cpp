@@ -1707,6 +1707,13 @@ Amr::checkPoint ()
     BL_PROFILE_REGION_START("Amr::checkPoint()");
     BL_PROFILE("Amr::checkPoint()");
 
+    if (AsyncOut::UseAsyncOut()) {
+        // ---- The previous checkpoint must be on disk before starting a new one.
+        BL_PROFILE("Amr::checkPoint()::drain");
+        AsyncOut::Finish();
+        ParallelDescriptor::Barrier("Amr::checkPoint::drain");
+    }
+
     VisMF::SetNOutFiles(checkpoint_nfiles);
     //
     // In checkpoint files always write out FABs in NATIVE format.
@@ -2651,7 +2658,13 @@ Amr::regrid (int  lbase,
             new_dmap[lev] = makeLoadBalanceDistributionMap(lev, time, new_grid_places[lev]);
         }
         else if (new_dmap[lev].empty()) {
-            new_dmap[lev].define(new_grid_places[lev]);
+            if (use_incremental_regrid && !initial && amr_level[lev]) {
+                new_dmap[lev] = MakeIncrementalDM(new_grid_places[lev],
+                                                  amr_level[lev]->boxArray(),
+                                                  amr_level[lev]->DistributionMap());
+            } else {
+                new_dmap[lev].define(new_grid_places[lev]);
+            }
         }
 
         AmrLevel* a = (*levelbld)(*this,lev,Geom(lev),new_grid_places[lev],
@@ -113,6 +113,8 @@ AmrMesh::InitAmrMesh (int max_level_in, const Vector<int>& n_cell_in,
 
     pp.queryAdd("n_proper",n_proper);
     pp.queryAdd("grid_eff",grid_eff);
+    pp.queryAdd("use_parallel_cluster",use_parallel_cluster);
+    pp.queryAdd("use_incremental_regrid",use_incremental_regrid);
     int cnt = pp.countval("n_error_buf");
     if (cnt > 0) {
         Vector<int> neb;
@@ -458,6 +460,12 @@ AmrMesh::MakeDistributionMap (int lev, BoxArray const& ba)
         amrex::Print() << "Creating new distribution map on level: " << lev << "\n";
     }
 
+    if (use_incremental_regrid && lev <= finest_level &&
+        !grids[lev].empty() && !dmap[lev].empty())
+    {
+        return MakeIncrementalDM(ba, grids[lev], dmap[lev]);
+    }
+
 #ifdef AMREX_USE_BITTREE
     // if (use_bittree) {
     //     return DistributionMapping(ba);
@@ -722,10 +730,18 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
         // Create initial cluster containing all tagged points.
         //
         Gpu::PinnedVector<IntVect> tagvec;
-        tags.collate(tagvec);
+        Long ntags = 0;
+        if (use_parallel_cluster) {
+            tags.local_collate(tagvec);
+            ntags = static_cast<Long>(tagvec.size());
+            ParallelDescriptor::ReduceLongSum(ntags);
+        } else {
+            tags.collate(tagvec);
+            ntags = static_cast<Long>(tagvec.size());
+        }
         tags.clear();
 
-        if (!tagvec.empty())
+        if (ntags > 0)
         {
             //
             // Created new level, now generate efficient grids.
@@ -736,23 +752,31 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
 
             if (levf > useFixedUpToLevel()) {
                 BoxList new_bx;
-                if (ParallelDescriptor::IOProcessor()) {
+                if (use_parallel_cluster || ParallelDescriptor::IOProcessor()) {
                     BL_PROFILE("AmrMesh-cluster");
-                    //
-                    // Construct initial cluster.
-                    //
-                    ClusterList clist(tagvec.data(), static_cast<Long>(tagvec.size()));
-                    if (use_new_chop) {
-                        clist.new_chop(grid_eff);
+                    if (use_parallel_cluster) {
+                        //
+                        // All processes cluster their own tags together.
+                        //
+                        new_bx = ParallelCluster(tagvec.data(), static_cast<Long>(tagvec.size()),
+                                                 grid_eff, use_new_chop, p_n_ba[levc]);
                     } else {
-                        clist.chop(grid_eff);
+                        //
+                        // Construct initial cluster.
+                        //
+                        ClusterList clist(tagvec.data(), static_cast<Long>(tagvec.size()));
+                        if (use_new_chop) {
+                            clist.new_chop(grid_eff);
+                        } else {
+                            clist.chop(grid_eff);
+                        }
+                        clist.intersect(p_n_ba[levc]);
+                        clist.boxList(new_bx);
                     }
-                    clist.intersect(p_n_ba[levc]);
                     //
                     // Efficient properly nested Clusters have been constructed
                     // now generate list of grids at level levf.
                     //
-                    clist.boxList(new_bx);
                     new_bx.refine(bf_lev[levc]);
                     new_bx.simplify();
 
@@ -761,7 +785,9 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Vector<BoxArray>&
                         new_bx.intersect(Geom(levc).Domain());
                     }
                 }
-                new_bx.Bcast();  // Broadcast the new BoxList to other processes
+                if (!use_parallel_cluster) {
+                    new_bx.Bcast();  // Broadcast the new BoxList to other processes
+                }
 
                 bool odd_ref_ratio = false;
                 for (auto const& rr : ref_ratio[levc]) {
@@ -1245,6 +1271,8 @@ std::ostream& operator<< (std::ostream& os, AmrMesh const& amr_mesh)
     os << "  refine_grid_layout_dims = " << amr_mesh.refine_grid_layout_dims << "\n";
     os << "  check_input = " << amr_mesh.check_input  << "\n";
     os << "  use_new_chop = " << amr_mesh.use_new_chop << "\n";
+    os << "  use_parallel_cluster = " << amr_mesh.use_parallel_cluster << "\n";
+    os << "  use_incremental_regrid = " << amr_mesh.use_incremental_regrid << "\n";
     os << "  iterate_on_new_grids = " << amr_mesh.iterate_on_new_grids << "\n";
     return os;
 }
@@ -5,8 +5,10 @@
 #include <AMReX_Vector.H>
 #include <AMReX_Array.H>
 #include <AMReX_BLProfiler.H>
+#include <AMReX_ParallelDescriptor.H>
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
 
 namespace amrex {
@@ -150,8 +152,9 @@ Cluster::minBox () noexcept
 
 namespace {
 
+template <typename T>
 int
-FindCut (const int* hist,
+FindCut (const T*   hist,
          int        lo,
          int        hi,
          CutStatus& status)
@@ -194,18 +197,18 @@ FindCut (const int* hist,
     // If we got here, there was no obvious cutpoint, try
     // finding place where change in second derivative is max.
     //
-    Vector<int> dhist(len,0);
+    Vector<T> dhist(len,0);
     for (i = 1; i < len-1; i++) {
         dhist[i] = hist[i+1] - 2*hist[i] + hist[i-1];
     }
 
-    int locmax = -1;
+    T locmax = -1;
     for (i = 0+MINOFF; i < len-MINOFF; i++)
     {
-        int iprev  = dhist[i-1];
-        int icur   = dhist[i];
-        int locdif = std::abs(iprev-icur);
-        if (iprev*icur < 0 && locdif >= locmax)
+        T iprev  = dhist[i-1];
+        T icur   = dhist[i];
+        T locdif = std::abs(iprev-icur);
+        if (((iprev < 0 && icur > 0) || (iprev > 0 && icur < 0)) && locdif >= locmax)
         {
             if (locdif > locmax)
             {
@@ -576,4 +579,330 @@ ClusterList::intersect (BoxArray& domba)
     domba.clear();
 }
 
+namespace {
+
+//
+// A cluster of tags that are distributed over processes.  The box and the
+// number of points are global, the points on this process are [begin,end).
+//
+struct DistCluster
+{
+    Box  bx;
+    Long npts     = 0;
+    Long begin    = 0;
+    Long end      = 0;
+    int  lo_child = -1;
+    int  hi_child = -1;
+
+    [[nodiscard]] Real eff () const noexcept {
+        return static_cast<Real>(double(npts) / bx.d_numPts());
+    }
+};
+
+//
+// Bounds of points are stored as (lo, -hi) so that they can be combined
+// over processes with a single min reduction.  No points gives lo > hi.
+//
+constexpr int NBND = 2*AMREX_SPACEDIM;
+
+void
+InitBounds (int* bnd) noexcept
+{
+    std::fill(bnd, bnd+NBND, INT_MAX);
+}
+
+void
+AddBounds (int* bnd, const IntVect& iv) noexcept
+{
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        bnd[n]                = std::min(bnd[n], iv[n]);
+        bnd[n+AMREX_SPACEDIM] = std::min(bnd[n+AMREX_SPACEDIM], -iv[n]);
+    }
+}
+
+Box
+BoundsToBox (const int* bnd) noexcept
+{
+    IntVect lo, hi;
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        lo[n] =  bnd[n];
+        hi[n] = -bnd[n+AMREX_SPACEDIM];
+    }
+    return Box(lo,hi);
+}
+
+//
+// Same choice of cut as Cluster::chop() and Cluster::new_chop().
+// Returns the direction or -1 if there is no valid cut.
+//
+int
+SelectCut (const Array<const Long*,AMREX_SPACEDIM>& hist,
+           const Box&                               bx,
+           int                                      invalid_dir,
+           IntVect&                                 cut)
+{
+    const int* lo = bx.loVect();
+    const int* hi = bx.hiVect();
+
+    CutStatus mincut = InvalidCut;
+    CutStatus status[AMREX_SPACEDIM] = {AMREX_D_DECL(InvalidCut,InvalidCut,InvalidCut)};
+    for (int n = 0; n < AMREX_SPACEDIM; n++)
+    {
+        if (n != invalid_dir)
+        {
+            cut[n] = FindCut(hist[n], lo[n], hi[n], status[n]);
+            if (status[n] < mincut)
+            {
+                mincut = status[n];
+            }
+        }
+    }
+    if (mincut == InvalidCut) { return -1; }
+
+    int dir = -1;
+    for (int n = 0, minlen = -1; n < AMREX_SPACEDIM; n++)
+    {
+        if (status[n] == mincut)
+        {
+            int mincutlen = std::min(cut[n]-lo[n],hi[n]-cut[n]);
+            if (mincutlen >= minlen)
+            {
+                dir = n;
+                minlen = mincutlen;
+            }
+        }
+    }
+    return dir;
+}
+}
+
+BoxList
+ParallelCluster (IntVect* pts, Long len, Real eff, bool use_new_chop, BoxArray& domba)
+{
+    BL_PROFILE("ParallelCluster()");
+
+    Vector<DistCluster> cl(1);
+    {
+        Vector<int> bnd(NBND);
+        InitBounds(bnd.data());
+        for (Long i = 0; i < len; i++) {
+            AddBounds(bnd.data(), pts[i]);
+        }
+        Long npts = len;
+        ParallelDescriptor::ReduceIntMin(bnd.data(), NBND);
+        ParallelDescriptor::ReduceLongSum(npts);
+
+        if (npts == 0) {
+            domba.clear();
+            return BoxList();
+        }
+
+        cl[0].bx   = BoundsToBox(bnd.data());
+        cl[0].npts = npts;
+        cl[0].end  = len;
+    }
+    //
+    // Chop all clusters with poor efficiency one generation at a time.
+    // Each generation needs one reduction of the histograms and one of the
+    // bounds of the candidate halves.
+    //
+    Vector<int> active{0};
+    while (!active.empty())
+    {
+        Vector<int> tochop;
+        for (int i : active) {
+            if (cl[i].eff() < eff) { tochop.push_back(i); }
+        }
+        const auto nchop = static_cast<int>(tochop.size());
+        if (nchop == 0) { break; }
+
+        Vector<Long> hoff(nchop*AMREX_SPACEDIM+1, 0);
+        for (int ic = 0; ic < nchop; ic++)
+        {
+            const IntVect len_bx = cl[tochop[ic]].bx.size();
+            for (int n = 0; n < AMREX_SPACEDIM; n++) {
+                hoff[ic*AMREX_SPACEDIM+n+1] = hoff[ic*AMREX_SPACEDIM+n] + len_bx[n];
+            }
+        }
+
+        Vector<Long> hist(hoff.back(), 0);
+        for (int ic = 0; ic < nchop; ic++)
+        {
+            const DistCluster& c = cl[tochop[ic]];
+            const IntVect& lo = c.bx.smallEnd();
+            Array<Long*,AMREX_SPACEDIM> h;
+            for (int n = 0; n < AMREX_SPACEDIM; n++) {
+                h[n] = hist.data() + hoff[ic*AMREX_SPACEDIM+n];
+            }
+            for (Long i = c.begin; i < c.end; i++)
+            {
+                for (int n = 0; n < AMREX_SPACEDIM; n++) {
+                    h[n][pts[i][n]-lo[n]]++;
+                }
+            }
+        }
+        ParallelDescriptor::ReduceLongSum(hist.data(), static_cast<int>(hist.size()));
+        //
+        // Candidate cuts.  The second one is only used by new_chop.
+        //
+        Vector<int>     dir(2*nchop, -1);
+        Vector<IntVect> cut(2*nchop);
+        Vector<Long>    nlo(2*nchop, 0);
+        for (int ic = 0; ic < nchop; ic++)
+        {
+            const DistCluster& c = cl[tochop[ic]];
+            Array<const Long*,AMREX_SPACEDIM> h;
+            for (int n = 0; n < AMREX_SPACEDIM; n++) {
+                h[n] = hist.data() + hoff[ic*AMREX_SPACEDIM+n];
+            }
+            for (int itry = 0; itry < (use_new_chop ? 2 : 1); itry++)
+            {
+                const int k = 2*ic+itry;
+                dir[k] = SelectCut(h, c.bx, (itry == 0) ? -1 : dir[2*ic], cut[k]);
+                if (dir[k] < 0) { break; }
+                const int d = dir[k];
+                for (int i = c.bx.smallEnd(d); i < cut[k][d]; i++) {
+                    nlo[k] += h[d][i-c.bx.smallEnd(d)];
+                }
+                if (nlo[k] <= 0 || nlo[k] >= c.npts) { dir[k] = -1; }
+            }
+            AMREX_ALWAYS_ASSERT(dir[2*ic] >= 0);
+        }
+
+        Vector<int> bnd(2*nchop*2*NBND);
+        for (int k = 0; k < 2*nchop; k++)
+        {
+            int* blo = bnd.data() + k*2*NBND;
+            int* bhi = blo + NBND;
+            InitBounds(blo);
+            InitBounds(bhi);
+            if (dir[k] >= 0)
+            {
+                const DistCluster& c = cl[tochop[k/2]];
+                const int d = dir[k];
+                const int cutd = cut[k][d];
+                for (Long i = c.begin; i < c.end; i++) {
+                    AddBounds((pts[i][d] < cutd) ? blo : bhi, pts[i]);
+                }
+            }
+        }
+        ParallelDescriptor::ReduceIntMin(bnd.data(), static_cast<int>(bnd.size()));
+
+        Vector<int> next;
+        next.reserve(2*nchop);
+        for (int ic = 0; ic < nchop; ic++)
+        {
+            const int ip = tochop[ic];
+            int k = 2*ic;
+            if (use_new_chop && dir[k+1] >= 0)
+            {
+                //
+                // Like new_chop, cut in a different direction unless the
+                // first cut improves the efficiency of one of the halves.
+                //
+                const Real oldeff = cl[ip].eff();
+                const Box  blo = BoundsToBox(bnd.data() + k*2*NBND);
+                const Box  bhi = BoundsToBox(bnd.data() + k*2*NBND + NBND);
+                const auto efflo = static_cast<Real>(double(nlo[k]) / blo.d_numPts());
+                const auto effhi = static_cast<Real>(double(cl[ip].npts-nlo[k]) / bhi.d_numPts());
+                if (efflo <= oldeff && effhi <= oldeff) { k++; }
+            }
+
+            IntVect* prt_it = std::partition(pts+cl[ip].begin, pts+cl[ip].end,
+                                             Cut(cut[k],dir[k]));
+
+            DistCluster clo, chi;
+            clo.bx    = BoundsToBox(bnd.data() + k*2*NBND);
+            clo.npts  = nlo[k];
+            clo.begin = cl[ip].begin;
+            clo.end   = prt_it - pts;
+            chi.bx    = BoundsToBox(bnd.data() + k*2*NBND + NBND);
+            chi.npts  = cl[ip].npts - nlo[k];
+            chi.begin = clo.end;
+            chi.end   = cl[ip].end;
+
+            cl[ip].lo_child = static_cast<int>(cl.size());
+            cl[ip].hi_child = cl[ip].lo_child + 1;
+            next.push_back(cl[ip].lo_child);
+            next.push_back(cl[ip].hi_child);
+            cl.push_back(clo);
+            cl.push_back(chi);
+        }
+        active.swap(next);
+    }
+    //
+    // Leaves in the order ClusterList::chop() would have left them in.
+    //
+    Vector<int> order{0};
+    for (Long i = 0; i < order.size(); i++)
+    {
+        while (cl[order[i]].lo_child >= 0)
+        {
+            order.push_back(cl[order[i]].hi_child);
+            order[i] = cl[order[i]].lo_child;
+        }
+    }
+    //
+    // Intersect with domba like ClusterList::intersect().
+    //
+    domba.removeOverlap();
+
+    const BoxList dom = domba.boxList();
+
+    BoxList bl;
+    Vector<Box> pieces;
+    Vector<int> owner;
+    for (int i : order)
+    {
+        bool assume_disjoint_ba = true;
+        if (domba.contains(cl[i].bx,assume_disjoint_ba))
+        {
+            bl.push_back(cl[i].bx);
+        }
+        else
+        {
+            BoxList bxdom = dom;
+            bxdom.intersect(cl[i].bx);
+            for (auto const& b : bxdom) {
+                pieces.push_back(b);
+                owner.push_back(i);
+            }
+        }
+    }
+
+    if (!pieces.empty())
+    {
+        const auto np = static_cast<int>(pieces.size());
+        Vector<int>  bnd(np*NBND);
+        Vector<Long> cnt(np, 0);
+        for (int ip = 0; ip < np; ip++)
+        {
+            InitBounds(bnd.data() + ip*NBND);
+            const DistCluster& c = cl[owner[ip]];
+            for (Long i = c.begin; i < c.end; i++)
+            {
+                if (pieces[ip].contains(pts[i]))
+                {
+                    AddBounds(bnd.data() + ip*NBND, pts[i]);
+                    cnt[ip]++;
+                }
+            }
+        }
+        ParallelDescriptor::ReduceIntMin(bnd.data(), static_cast<int>(bnd.size()));
+        ParallelDescriptor::ReduceLongSum(cnt.data(), np);
+
+        for (int ip = 0; ip < np; ip++) {
+            if (cnt[ip] > 0) {
+                bl.push_back(BoundsToBox(bnd.data() + ip*NBND));
+            }
+        }
+    }
+
+    domba.clear();
+
+    return bl;
+}
+
 }
@@ -48,6 +48,7 @@ namespace {
     Long the_comms_arena_release_threshold = std::numeric_limits<Long>::max();
     Long the_async_arena_release_threshold = std::numeric_limits<Long>::max();
     bool the_arena_is_managed = false;
+    bool the_arena_thread_cache = false;
     bool abort_on_out_of_gpu_memory = false;
 }
 
@@ -298,12 +299,16 @@ Arena::Initialize ()
     pp.queryAdd("the_comms_arena_release_threshold", the_comms_arena_release_threshold);
     pp.queryAdd(  "the_async_arena_release_threshold",   the_async_arena_release_threshold);
     pp.queryAdd("the_arena_is_managed", the_arena_is_managed);
+    pp.queryAdd("the_arena_thread_cache", the_arena_thread_cache);
     pp.queryAdd("abort_on_out_of_gpu_memory", abort_on_out_of_gpu_memory);
 
     {
 #if defined(BL_COALESCE_FABS) || defined(AMREX_USE_GPU)
         ArenaInfo ai{};
         ai.SetReleaseThreshold(the_arena_release_threshold);
+        if (the_arena_thread_cache) {
+            ai.SetThreadCache();
+        }
         if (the_arena_is_managed) {
             the_arena = new CArena(0, ai.SetPreferred());
 #ifdef AMREX_USE_GPU
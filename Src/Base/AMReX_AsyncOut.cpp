@@ -1,19 +1,28 @@
 #include <AMReX_AsyncOut.H>
 #include <AMReX_BackgroundThread.H>
+#include <AMReX_BLProfiler.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Vector.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
 #include <AMReX.H>
 
+#include <condition_variable>
+#include <mutex>
+
 namespace amrex::AsyncOut {
 
 namespace {
 
 int s_asyncout = false;
 int s_noutfiles = 64;
+Long s_max_bytes = 0; // <= 0: no limit
 MPI_Comm s_comm = MPI_COMM_NULL;
 
+Long s_reserved_bytes = 0;
+std::mutex s_reserve_mutex;
+std::condition_variable s_reserve_cond;
+
 std::unique_ptr<BackgroundThread> s_thread;
 
 WriteInfo s_info;
@@ -27,6 +36,7 @@ void Initialize ()
     ParmParse pp("amrex");
     pp.queryAdd("async_out", s_asyncout);
     pp.queryAdd("async_out_nfiles", s_noutfiles);
+    pp.queryAdd("async_out_max_bytes", s_max_bytes);
 
     int nprocs = ParallelDescriptor::NProcs();
     s_noutfiles = std::min(s_noutfiles, nprocs);
@@ -109,6 +119,27 @@ void Finish ()
     }
 }
 
+void Reserve (Long nbytes)
+{
+    BL_PROFILE("AsyncOut::Reserve()");
+    std::unique_lock<std::mutex> lck(s_reserve_mutex);
+    if (s_max_bytes > 0) {
+        s_reserve_cond.wait(lck, [=] () -> bool {
+            return s_reserved_bytes == 0 || s_reserved_bytes + nbytes <= s_max_bytes;
+        });
+    }
+    s_reserved_bytes += nbytes;
+}
+
+void Release (Long nbytes)
+{
+    {
+        std::lock_guard<std::mutex> lck(s_reserve_mutex);
+        s_reserved_bytes -= nbytes;
+    }
+    s_reserve_cond.notify_all();
+}
+
 void Wait ()
 {
 #ifdef AMREX_USE_MPI
@@ -2,6 +2,7 @@
 #include <AMReX_CArena.H>
 #include <AMReX_BLassert.H>
 #include <AMReX_Gpu.H>
+#include <AMReX_OpenMP.H>
 #include <AMReX_ParallelReduce.H>
 
 #ifdef AMREX_TINY_PROFILING
@@ -24,6 +25,10 @@ CArena::CArena (std::size_t hunk_size, ArenaInfo info)
     arena_info = info;
     BL_ASSERT(m_hunk >= hunk_size);
     BL_ASSERT(m_hunk%Arena::align_size == 0);
+
+    if (arena_info.use_thread_cache && OpenMP::get_max_threads() > 1) {
+        m_thread_cache.resize(OpenMP::get_max_threads());
+    }
 }
 
 CArena::~CArena ()
@@ -42,11 +47,158 @@ CArena::~CArena ()
 void*
 CArena::alloc (std::size_t nbytes)
 {
-    std::lock_guard<std::mutex> lock(carena_mutex);
     nbytes = Arena::align(nbytes == 0 ? 1 : nbytes);
+
+    if (nbytes <= (std::size_t(1) << thread_cache_max_class)) {
+        if (auto* tc = thread_cache()) {
+            return alloc_cached(*tc, nbytes);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(carena_mutex);
     return alloc_protected(nbytes);
 }
 
+CArena::ThreadCache*
+CArena::thread_cache () noexcept
+{
+#ifdef AMREX_USE_OMP
+    // Only the threads of a non-nested parallel region have distinct
+    // thread numbers.
+    if (!m_thread_cache.empty() && omp_in_parallel() && omp_get_level() == 1) {
+        auto tid = static_cast<std::size_t>(omp_get_thread_num());
+        if (tid < m_thread_cache.size()) {
+            return &m_thread_cache[tid];
+        }
+    }
+#endif
+    return nullptr;
+}
+
+int
+CArena::thread_cache_class (std::size_t nbytes) noexcept
+{
+    if (nbytes <= (std::size_t(1) << thread_cache_min_class)) { return 0; }
+    // 2^k < nbytes <= 2^(k+1)
+    int k = thread_cache_min_class;
+    while ((std::size_t(2) << k) < nbytes) { ++k; }
+    const std::size_t step = (std::size_t(1) << k) / thread_cache_class_steps;
+    const auto i = static_cast<int>((nbytes - (std::size_t(1) << k) + step - 1) / step);
+    return (k-thread_cache_min_class)*thread_cache_class_steps + i;
+}
+
+std::size_t
+CArena::thread_cache_class_size (int ic) noexcept
+{
+    if (ic == 0) { return std::size_t(1) << thread_cache_min_class; }
+    const int k = thread_cache_min_class + (ic-1)/thread_cache_class_steps;
+    const int i = (ic-1)%thread_cache_class_steps + 1;
+    return (std::size_t(1) << k) + i * ((std::size_t(1) << k) / thread_cache_class_steps);
+}
+
+void*
+CArena::alloc_cached (ThreadCache& tc, std::size_t nbytes)
+{
+    const int ic = thread_cache_class(nbytes);
+    const std::size_t sz = thread_cache_class_size(ic);
+    auto& bin = tc.bins[ic];
+
+    if (bin.empty()) {
+        std::lock_guard<std::mutex> lock(carena_mutex);
+
+        drain_remote(tc);
+
+        if (bin.empty()) {
+            ++tc.nmiss;
+            void* vp = alloc_protected(sz);
+            auto busy_it = m_busylist.find(Node(vp,nullptr,0));
+            BL_ASSERT(busy_it != m_busylist.end());
+            const_cast<Node&>(*busy_it).cache_owner(static_cast<int>(&tc - m_thread_cache.data()));
+            tc.owned.emplace(vp, ic);
+            return vp;
+        }
+    }
+
+    ++tc.nhit;
+    void* vp = bin.back();
+    bin.pop_back();
+    tc.nbytes -= sz;
+    m_actually_used += sz;
+
+#ifdef AMREX_TINY_PROFILING
+    if (m_do_profiling) {
+        // The statistics are not thread safe.
+        std::lock_guard<std::mutex> lock(carena_mutex);
+        auto busy_it = m_busylist.find(Node(vp,nullptr,0));
+        BL_ASSERT(busy_it != m_busylist.end());
+        const_cast<Node&>(*busy_it).mem_stat(TinyProfiler::memory_alloc(sz, m_profiling_stats));
+    }
+#endif
+
+    return vp;
+}
+
+void
+CArena::free_cached (ThreadCache& tc, void* vp, int ic)
+{
+    const std::size_t sz = thread_cache_class_size(ic);
+
+#ifdef AMREX_TINY_PROFILING
+    if (m_do_profiling) {
+        std::lock_guard<std::mutex> lock(carena_mutex);
+        auto busy_it = m_busylist.find(Node(vp,nullptr,0));
+        BL_ASSERT(busy_it != m_busylist.end());
+        account_free(*busy_it);
+    } else
+#endif
+    {
+        m_actually_used -= sz;
+    }
+
+    auto& bin = tc.bins[ic];
+    bin.push_back(vp);
+    tc.nbytes += sz;
+    if (bin.size() > thread_cache_max_blocks) {
+        flush_thread_cache(tc, thread_cache_max_blocks/2);
+    } else if (tc.nbytes > thread_cache_max_bytes) {
+        flush_thread_cache(tc, 0);
+    }
+}
+
+void
+CArena::drain_remote (ThreadCache& tc)
+{
+    for (void* vp : tc.remote) {
+        const int ic = tc.owned.at(vp);
+        tc.bins[ic].push_back(vp);
+        tc.nbytes += thread_cache_class_size(ic);
+    }
+    tc.remote.clear();
+}
+
+void
+CArena::flush_thread_cache (ThreadCache& tc, std::size_t nkeep)
+{
+    std::lock_guard<std::mutex> lock(carena_mutex);
+
+    drain_remote(tc);
+
+    for (int ic = 0; ic < thread_cache_num_classes; ++ic) {
+        auto& bin = tc.bins[ic];
+        while (bin.size() > nkeep) {
+            void* vp = bin.back();
+            bin.pop_back();
+            tc.owned.erase(vp);
+            tc.nbytes -= thread_cache_class_size(ic);
+            auto busy_it = m_busylist.find(Node(vp,nullptr,0));
+            BL_ASSERT(busy_it != m_busylist.end());
+            const_cast<Node&>(*busy_it).cache_owner(-1);
+            // The block has already been accounted as free.
+            release_protected(busy_it);
+        }
+    }
+}
+
 void*
 CArena::alloc_protected (std::size_t nbytes)
 {
@@ -151,9 +303,12 @@ CArena::alloc_in_place (void* pt, std::size_t szmin, std::size_t szmax)
             return std::make_pair(pt, busy_it->size());
         }
 
+        // The size of a block owned by a thread cache must not change.
         void* next_block = (char*)pt + busy_it->size();
         auto next_it = m_freelist.find(Node(next_block,nullptr,0));
-        if (next_it != m_freelist.end() && busy_it->coalescable(*next_it)) {
+        if (next_it != m_freelist.end() && busy_it->coalescable(*next_it) &&
+            busy_it->cache_owner() < 0)
+        {
             std::size_t total_size = busy_it->size() + next_it->size();
             if (total_size >= szmax) {
                 // Must use nbytes_max instead of szmax for alignment.
@@ -224,7 +379,8 @@ CArena::shrink_in_place (void* pt, std::size_t new_size)
     if (new_size > old_size) {
         amrex::Abort("CArena::shrink_in_place: wrong size. Cannot shrink to a larger size.");
         return nullptr;
-    } else if (new_size == old_size) {
+    } else if (new_size == old_size || busy_it->cache_owner() >= 0) {
+        // The size of a block owned by a thread cache must not change.
         return pt;
     } else {
         auto const leftover_size = old_size - new_size;
@@ -271,8 +427,32 @@ CArena::free (void* vp)
         return;
     }
 
+    if (auto* tc = thread_cache()) {
+        auto owned_it = tc->owned.find(vp);
+        if (owned_it != tc->owned.end()) {
+            free_cached(*tc, vp, owned_it->second);
+            return;
+        }
+    }
+
     std::lock_guard<std::mutex> lock(carena_mutex);
+    free_protected(vp);
+}
 
+void
+CArena::account_free (Node const& node)
+{
+    m_actually_used -= node.size();
+
+#ifdef AMREX_TINY_PROFILING
+    TinyProfiler::memory_free(node.size(), node.mem_stat());
+    const_cast<Node&>(node).mem_stat(nullptr);
+#endif
+}
+
+void
+CArena::free_protected (void* vp)
+{
     //
     // `vp' had better be in the busy list.
     //
@@ -283,12 +463,23 @@ CArena::free (void* vp)
     }
     BL_ASSERT(m_freelist.find(*busy_it) == m_freelist.end());
 
-    m_actually_used -= busy_it->size();
+    account_free(*busy_it);
 
-#ifdef AMREX_TINY_PROFILING
-    TinyProfiler::memory_free(busy_it->size(), busy_it->mem_stat());
-#endif
+    if (busy_it->cache_owner() >= 0) {
+        //
+        // The block belongs to the cache of another thread, which will pick
+        // it up the next time it takes the lock.
+        //
+        m_thread_cache[busy_it->cache_owner()].remote.push_back(vp);
+        return;
+    }
+
+    release_protected(busy_it);
+}
 
+void
+CArena::release_protected (std::unordered_set<Node, Node::hash>::iterator busy_it)
+{
     //
     // Put free'd block on free list and save iterator to insert()ed position.
     //
@@ -354,6 +545,14 @@ CArena::free (void* vp)
 std::size_t
 CArena::freeUnused ()
 {
+    // The thread caches can only be flushed by another thread when no
+    // parallel region is running.
+    if (!OpenMP::in_parallel()) {
+        for (auto& tc : m_thread_cache) {
+            flush_thread_cache(tc, 0);
+        }
+    }
+
     std::lock_guard<std::mutex> lock(carena_mutex);
     return freeUnused_protected();
 }
@@ -427,7 +626,18 @@ CArena::registerForProfiling ([[maybe_unused]] const std::string& memory_name)
 {
 #ifdef AMREX_TINY_PROFILING
     m_do_profiling = true;
-    TinyProfiler::RegisterArena(memory_name, m_profiling_stats);
+    std::function<MemCacheStat()> cache_stat;
+    if (!m_thread_cache.empty()) {
+        cache_stat = [this] () {
+            MemCacheStat r;
+            for (auto const& tc : m_thread_cache) {
+                r.nhit += tc.nhit;
+                r.nmiss += tc.nmiss;
+            }
+            return r;
+        };
+    }
+    TinyProfiler::RegisterArena(memory_name, m_profiling_stats, std::move(cache_stat));
 #endif
 }
 
@@ -490,6 +700,17 @@ CArena::PrintUsage (std::ostream& os, std::string const& name, std::string const
     os << space << "[" << name << "] space used      (MB): " << actual_megabytes << "\n";
     os << space << "[" << name << "]: " << m_alloc.size() << " allocs, "
        << m_busylist.size() << " busy blocks, " << m_freelist.size() << " free blocks\n";
+    if (!m_thread_cache.empty()) {
+        Long nhit = 0, nmiss = 0;
+        std::size_t nbytes = 0;
+        for (auto const& tc : m_thread_cache) {
+            nhit += tc.nhit;
+            nmiss += tc.nmiss;
+            nbytes += tc.nbytes;
+        }
+        os << space << "[" << name << "]: thread caches hold " << nbytes/(1024*1024)
+           << " MB, " << nhit << " hits, " << nmiss << " misses\n";
+    }
 }
 
 std::ostream& operator<< (std::ostream& os, const CArena& arena)
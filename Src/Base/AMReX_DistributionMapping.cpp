@@ -17,6 +17,7 @@
 #include <map>
 #include <vector>
 #include <queue>
+#include <functional>
 #include <algorithm>
 #include <numeric>
 #include <string>
@@ -25,6 +26,9 @@
 
 namespace {
 int flag_verbose_mapper;
+// Node id of each rank in ParallelDescriptor::Communicator().  This is
+// computed on demand by DistributionMapping::RankToNode().
+amrex::Vector<int> rank_to_node;
 }
 
 namespace amrex {
@@ -37,6 +41,8 @@ namespace amrex {
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    int    graph_ngrow;
+    Real   graph_imbalance;
 
 // We default to SFC.
 DistributionMapping::Strategy DistributionMapping::m_Strategy = DistributionMapping::SFC;
@@ -74,6 +80,9 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case GRAPH:
+        m_BuildMap = &DistributionMapping::GraphProcessorMap;
+        break;
     default:
         amrex::Error("Bad DistributionMapping::Strategy");
     }
@@ -114,6 +123,8 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9_rt;
     node_size        = 0;
+    graph_ngrow      = 1;
+    graph_imbalance  = 0.05_rt;
     flag_verbose_mapper = 0;
 
     ParmParse pp("DistributionMapping");
@@ -124,6 +135,8 @@ DistributionMapping::Initialize ()
     pp.queryAdd("sfc_threshold",       sfc_threshold);
     pp.queryAdd("node_size",           node_size);
     pp.queryAdd("verbose_mapper",      flag_verbose_mapper);
+    pp.queryAdd("graph_ngrow",         graph_ngrow);
+    pp.queryAdd("graph_imbalance",     graph_imbalance);
 
     std::string theStrategy;
 
@@ -145,6 +158,10 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "GRAPH")
+        {
+            strategy(GRAPH);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -170,6 +187,31 @@ DistributionMapping::Finalize ()
     m_Strategy = SFC;
 
     DistributionMapping::m_BuildMap = nullptr;
+
+    rank_to_node.clear();
+}
+
+const Vector<int>&
+DistributionMapping::RankToNode ()
+{
+    const int nprocs = ParallelDescriptor::NProcs();
+    if (static_cast<int>(rank_to_node.size()) != nprocs)
+    {
+        rank_to_node.resize(nprocs);
+        if (node_size > 0) {
+            for (int r = 0; r < nprocs; ++r) {
+                rank_to_node[r] = (r/node_size)*node_size;
+            }
+        } else {
+            int leader = ParallelDescriptor::NodeLeader();
+            rank_to_node[0] = leader;
+#ifdef BL_USE_MPI
+            BL_MPI_REQUIRE(MPI_Allgather(&leader, 1, MPI_INT, rank_to_node.data(), 1, MPI_INT,
+                                         ParallelDescriptor::Communicator()));
+#endif
+        }
+    }
+    return rank_to_node;
 }
 
 void
@@ -1573,6 +1615,337 @@ DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
     RRSFCDoIt(boxes,nprocs);
 }
 
+namespace {
+
+    //
+    // Undirected graph of boxes in compressed sparse row format.  There is
+    // an edge between two boxes if one of them grown by the number of ghost
+    // cells intersects the other.  The edge weight is the number of ghost
+    // cells exchanged between them in both directions.
+    //
+    struct BoxGraph
+    {
+        std::vector<int>  offset; // size of nboxes+1
+        std::vector<int>  nbr;
+        std::vector<Long> wgt;
+    };
+
+    BoxGraph
+    makeBoxGraph (const BoxArray& boxes, int ngrow)
+    {
+        BL_PROFILE("DistributionMapping::makeBoxGraph()");
+
+        const int N = static_cast<int>(boxes.size());
+        std::vector<std::vector<std::pair<int,Long>>> edges(N);
+        std::vector<std::pair<int,Box>> isects;
+        for (int i = 0; i < N; ++i) {
+            boxes.intersections(amrex::grow(boxes[i],ngrow), isects);
+            for (auto const& is : isects) {
+                if (is.first != i) {
+                    const Long v = is.second.numPts();
+                    edges[i].emplace_back(is.first, v);
+                    edges[is.first].emplace_back(i, v);
+                }
+            }
+        }
+
+        BoxGraph g;
+        g.offset.resize(N+1, 0);
+        for (int i = 0; i < N; ++i) {
+            auto& e = edges[i];
+            std::sort(e.begin(), e.end());
+            for (int k = 0, ne = static_cast<int>(e.size()); k < ne; ++k) {
+                if (g.nbr.size() > std::size_t(g.offset[i]) && g.nbr.back() == e[k].first) {
+                    g.wgt.back() += e[k].second;
+                } else {
+                    g.nbr.push_back(e[k].first);
+                    g.wgt.push_back(e[k].second);
+                }
+            }
+            g.offset[i+1] = static_cast<int>(g.nbr.size());
+            std::vector<std::pair<int,Long>>().swap(e);
+        }
+        return g;
+    }
+
+    //
+    // Partition the vertices in verts, which are in SFC order, into
+    // target.size() parts.  The weight of part p should be close to
+    // target[p] times the total weight.  On input, part[v] must be -1 for
+    // all vertices not in verts.  On output, part[v] for v in verts
+    // contains its part.
+    //
+    // The initial partition is a split of the space filling curve.  It is
+    // then refined by greedily moving boundary vertices to the neighboring
+    // part they are most strongly connected to, as long as the weight of
+    // that part does not exceed (1+imbalance) times its target weight.
+    //
+    void
+    partitionBoxGraph (BoxGraph const& g, std::vector<int> const& verts,
+                       std::vector<Long> const& wgts, std::vector<Real> const& target,
+                       Real imbalance, std::vector<int>& part)
+    {
+        const int nparts = static_cast<int>(target.size());
+        if (nparts == 1) {
+            for (int v : verts) { part[v] = 0; }
+            return;
+        }
+
+        Real totwgt = 0;
+        for (int v : verts) { totwgt += static_cast<Real>(wgts[v]); }
+
+        std::vector<Real> maxwgt(nparts);
+        std::vector<Long> pwgt(nparts, 0);
+        std::vector<int>  pcnt(nparts, 0);
+
+        {
+            int p = 0;
+            Real cumtarget = target[0]*totwgt;
+            Real cumwgt = 0;
+            for (int v : verts) {
+                const auto w = static_cast<Real>(wgts[v]);
+                while (p < nparts-1 && cumwgt + Real(0.5)*w > cumtarget) {
+                    ++p;
+                    cumtarget += target[p]*totwgt;
+                }
+                part[v] = p;
+                pwgt[p] += wgts[v];
+                ++pcnt[p];
+                cumwgt += w;
+            }
+        }
+
+        for (int p = 0; p < nparts; ++p) {
+            maxwgt[p] = (Real(1.0)+imbalance)*target[p]*totwgt;
+        }
+
+        std::vector<Long> conn(nparts, 0);
+        std::vector<int> touched;
+        constexpr int max_passes = 16;
+        for (int pass = 0; pass < max_passes; ++pass)
+        {
+            int nmoves = 0;
+            for (int v : verts)
+            {
+                const int own = part[v];
+                if (pcnt[own] == 1) { continue; }
+
+                touched.clear();
+                bool boundary = false;
+                for (int k = g.offset[v]; k < g.offset[v+1]; ++k) {
+                    const int p = part[g.nbr[k]];
+                    if (p >= 0) {
+                        if (conn[p] == 0) { touched.push_back(p); }
+                        conn[p] += g.wgt[k];
+                        if (p != own) { boundary = true; }
+                    }
+                }
+
+                if (boundary) {
+                    int best = own;
+                    Long best_gain = 0;
+                    std::sort(touched.begin(), touched.end());
+                    for (int p : touched) {
+                        const Long gain = conn[p] - conn[own];
+                        if (p != own && gain > best_gain &&
+                            static_cast<Real>(pwgt[p]+wgts[v]) <= maxwgt[p])
+                        {
+                            best = p;
+                            best_gain = gain;
+                        }
+                    }
+                    if (best != own) {
+                        part[v] = best;
+                        pwgt[own] -= wgts[v];
+                        pwgt[best] += wgts[v];
+                        --pcnt[own];
+                        ++pcnt[best];
+                        ++nmoves;
+                    }
+                }
+
+                for (int p : touched) { conn[p] = 0; }
+            }
+            if (nmoves == 0) { break; }
+        }
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMapDoIt (const BoxArray&          boxes,
+                                            const std::vector<Long>& wgts,
+                                            int                      nprocs,
+                                            Real*                    eff)
+{
+    BL_PROFILE("DistributionMapping::GraphProcessorMapDoIt()");
+
+    AMREX_ASSERT(nprocs > 0 && nprocs <= ParallelContext::NProcsSub());
+
+    const int N = static_cast<int>(boxes.size());
+
+    //
+    // Find the node of each rank in the current sub-communicator.  The
+    // table over all ranks may only be built collectively over all ranks,
+    // so for a sub-communicator without that table we gather the node
+    // leaders over the sub-communicator instead.
+    //
+    std::vector<int> sub_rank_to_node(ParallelContext::NProcsSub());
+    if (ParallelContext::NProcsSub() == ParallelDescriptor::NProcs() || node_size > 0 ||
+        static_cast<int>(rank_to_node.size()) == ParallelDescriptor::NProcs())
+    {
+        auto const& r2n = RankToNode();
+        for (int r = 0; r < ParallelContext::NProcsSub(); ++r) {
+            sub_rank_to_node[r] = r2n[ParallelContext::local_to_global_rank(r)];
+        }
+    }
+    else
+    {
+        int leader = ParallelDescriptor::NodeLeader();
+        sub_rank_to_node[0] = leader;
+#ifdef BL_USE_MPI
+        BL_MPI_REQUIRE(MPI_Allgather(&leader, 1, MPI_INT, sub_rank_to_node.data(), 1, MPI_INT,
+                                     ParallelContext::CommunicatorSub()));
+#endif
+    }
+
+    //
+    // Group the ranks by node.  Nodes are ordered by their lowest rank.
+    //
+    std::vector<std::vector<int> > node_ranks;
+    {
+        std::map<int,int> node_index;
+        for (int r = 0; r < nprocs; ++r) {
+            const int node = sub_rank_to_node[r];
+            auto it = node_index.find(node);
+            if (it == node_index.end()) {
+                node_index[node] = static_cast<int>(node_ranks.size());
+                node_ranks.push_back({r});
+            } else {
+                node_ranks[it->second].push_back(r);
+            }
+        }
+    }
+    const int nnodes = static_cast<int>(node_ranks.size());
+
+    if (flag_verbose_mapper) {
+        Print() << "DM: GraphProcessorMapDoIt called..." << '\n'
+                << "  (nprocs, nnodes) = (" << nprocs << ", " << nnodes << ")\n";
+    }
+
+    std::vector<int> sfc_order;
+    {
+        std::vector<SFCToken> tokens;
+        tokens.reserve(N);
+        for (int i = 0; i < N; ++i) {
+            const Box& bx = boxes[i];
+            tokens.push_back(makeSFCToken(i, bx.smallEnd()));
+        }
+        std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+        sfc_order.reserve(N);
+        for (auto const& t : tokens) {
+            sfc_order.push_back(t.m_box);
+        }
+    }
+
+    const BoxGraph g = makeBoxGraph(boxes, graph_ngrow);
+
+    std::vector<int> part(N, -1);
+
+    //
+    // First, partition the boxes across nodes in proportion to their
+    // number of ranks.
+    //
+    std::vector<int> box_node(N);
+    {
+        std::vector<Real> target(nnodes);
+        for (int n = 0; n < nnodes; ++n) {
+            target[n] = static_cast<Real>(node_ranks[n].size()) / static_cast<Real>(nprocs);
+        }
+        partitionBoxGraph(g, sfc_order, wgts, target, graph_imbalance, part);
+        for (int i = 0; i < N; ++i) {
+            box_node[i] = part[i];
+            part[i] = -1;
+        }
+    }
+
+    //
+    // Then, partition the boxes of each node across its ranks.
+    //
+    std::vector<std::vector<int> > node_boxes(nnodes);
+    for (int i : sfc_order) {
+        node_boxes[box_node[i]].push_back(i);
+    }
+
+    std::vector<Long> rank_wgt(nprocs, 0);
+    for (int n = 0; n < nnodes; ++n)
+    {
+        auto const& ranks = node_ranks[n];
+        const int nr = static_cast<int>(ranks.size());
+        std::vector<Real> target(nr, Real(1.0)/static_cast<Real>(nr));
+        partitionBoxGraph(g, node_boxes[n], wgts, target, graph_imbalance, part);
+        for (int i : node_boxes[n]) {
+            const int r = ranks[part[i]];
+            m_ref->m_pmap[i] = ParallelContext::local_to_global_rank(r);
+            rank_wgt[r] += wgts[i];
+            part[i] = -1;
+        }
+    }
+
+    if (eff || verbose)
+    {
+        Long sum_wgt = 0, max_wgt = 0;
+        for (Long w : rank_wgt) {
+            max_wgt = std::max(max_wgt, w);
+            sum_wgt += w;
+        }
+        Real efficiency = static_cast<Real>(sum_wgt)/static_cast<Real>(nprocs*max_wgt);
+        if (eff) { *eff = efficiency; }
+
+        if (verbose)
+        {
+            Long cut_node = 0, cut_rank = 0, total = 0;
+            for (int i = 0; i < N; ++i) {
+                for (int k = g.offset[i]; k < g.offset[i+1]; ++k) {
+                    const int j = g.nbr[k];
+                    if (j > i) {
+                        total += g.wgt[k];
+                        if (m_ref->m_pmap[i] != m_ref->m_pmap[j]) {
+                            cut_rank += g.wgt[k];
+                            if (box_node[i] != box_node[j]) {
+                                cut_node += g.wgt[k];
+                            }
+                        }
+                    }
+                }
+            }
+            amrex::Print() << "GRAPH efficiency: " << efficiency
+                           << ", ghost cells across ranks: " << cut_rank
+                           << ", across nodes: " << cut_node
+                           << ", total: " << total << '\n';
+        }
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMap (const BoxArray& boxes, int nprocs)
+{
+    BL_ASSERT( ! boxes.empty());
+
+    m_ref->clear();
+    m_ref->m_pmap.resize(boxes.size());
+
+    std::vector<Long> wgts;
+    wgts.reserve(boxes.size());
+    for (int i = 0, N = static_cast<int>(boxes.size()); i < N; ++i)
+    {
+        wgts.push_back(boxes[i].numPts());
+    }
+
+    // The default nprocs is ParallelDescriptor::NProcs(), which is more
+    // than the number of ranks in a sub-communicator.
+    GraphProcessorMapDoIt(boxes,wgts,std::min(nprocs,ParallelContext::NProcsSub()));
+}
+
 DistributionMapping
 DistributionMapping::makeKnapSack (const Vector<Real>& rcost, int nmax)
 {
@@ -1820,6 +2193,46 @@ DistributionMapping::makeSFC (const Vector<Real>& rcost, const BoxArray& ba, Rea
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeGraph (const MultiFab& weight)
+{
+    BL_PROFILE("makeGraph");
+    Vector<Long> cost = gather_weights(weight);
+    DistributionMapping r;
+    r.m_ref->m_pmap.resize(cost.size());
+    r.GraphProcessorMapDoIt(weight.boxArray(), cost, ParallelContext::NProcsSub());
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const Vector<Real>& rcost, const BoxArray& ba)
+{
+    Real eff;
+    return makeGraph(rcost, ba, eff);
+}
+
+DistributionMapping
+DistributionMapping::makeGraph (const Vector<Real>& rcost, const BoxArray& ba, Real& eff)
+{
+    BL_PROFILE("makeGraph");
+
+    DistributionMapping r;
+
+    Vector<Long> cost(rcost.size());
+
+    Real wmax = *std::max_element(rcost.begin(), rcost.end());
+    Real scale = (wmax == 0) ? 1.e9_rt : 1.e9_rt/wmax;
+
+    for (int i = 0; i < rcost.size(); ++i) {
+        cost[i] = Long(rcost[i]*scale) + 1L;
+    }
+
+    r.m_ref->m_pmap.resize(cost.size());
+    r.GraphProcessorMapDoIt(ba, cost, ParallelContext::NProcsSub(), &eff);
+
+    return r;
+}
+
 DistributionMapping
 DistributionMapping::makeSFC (const LayoutData<Real>& rcost_local,
                               Real& currentEfficiency, Real& proposedEfficiency,
@@ -2060,4 +2473,95 @@ DistributionMapping MakeSimilarDM (const BoxArray& ba, const BoxArray& src_ba,
     return DistributionMapping(std::move(pmap));
 }
 
+DistributionMapping MakeIncrementalDM (const BoxArray& ba, const BoxArray& old_ba,
+                                       const DistributionMapping& old_dm, Real keep_eff)
+{
+    BL_PROFILE("MakeIncrementalDM");
+
+    if (old_ba.empty() || ba.ixType() != old_ba.ixType()) { return DistributionMapping(ba); }
+
+    const int nprocs = ParallelContext::NProcsSub();
+    const auto nboxes = static_cast<int>(ba.size());
+
+    Vector<int> pmap(nboxes, -1);
+    Vector<Long> cost(nboxes);
+    Vector<Long> load(nprocs, 0);
+    Vector<int> added;
+    for (int i = 0; i < nboxes; ++i) {
+        const Box& bx = ba[i];
+        cost[i] = bx.numPts();
+        bool first_only = false;
+        for (const auto& isect : old_ba.intersections(bx, first_only, 0)) {
+            if (old_ba[isect.first] == bx) {
+                int lrank = ParallelContext::global_to_local_rank(old_dm[isect.first]);
+                if (lrank >= 0 && lrank < nprocs) {
+                    pmap[i] = old_dm[isect.first];
+                    load[lrank] += cost[i];
+                }
+                break;
+            }
+        }
+        if (pmap[i] < 0) { added.push_back(i); }
+    }
+
+    if (static_cast<int>(added.size()) == nboxes) { return DistributionMapping(ba); }
+
+    std::stable_sort(added.begin(), added.end(),
+                     [&] (int a, int b) { return cost[a] > cost[b]; });
+
+    using LIpair = std::pair<Long,int>;
+    std::priority_queue<LIpair, std::vector<LIpair>, std::greater<>> procs;
+    for (int iproc = 0; iproc < nprocs; ++iproc) {
+        procs.emplace(load[iproc], iproc);
+    }
+    for (int i : added) {
+        LIpair p = procs.top();
+        procs.pop();
+        pmap[i] = ParallelContext::local_to_global_rank(p.second);
+        p.first += cost[i];
+        procs.push(p);
+    }
+
+    DistributionMapping r(std::move(pmap));
+
+    // The load balance efficiency over the processes of the current
+    // ParallelContext frame, which all the boxes are mapped to.
+    auto efficiency = [&] (DistributionMapping const& dm) -> Real
+    {
+        Vector<int> lranks(nboxes);
+        ParallelContext::global_to_local_rank(lranks.data(), dm.ProcessorMap().data(), nboxes);
+        Vector<Long> wgts(nprocs, 0);
+        for (int i = 0; i < nboxes; ++i) {
+            AMREX_ASSERT(lranks[i] >= 0 && lranks[i] < nprocs);
+            wgts[lranks[i]] += cost[i];
+        }
+        Long max_weight = 0, sum_weight = 0;
+        for (Long w : wgts) {
+            max_weight = std::max(w, max_weight);
+            sum_weight += w;
+        }
+        return static_cast<Real>(sum_weight) /
+            (static_cast<Real>(nprocs) * static_cast<Real>(max_weight));
+    };
+
+    const Real eff = efficiency(r);
+
+    // No mapping can have a higher efficiency than max_eff, so we only need
+    // to build a new mapping if r might fall short of it.
+    Long tot_cost = 0, max_cost = 0;
+    for (Long c : cost) {
+        tot_cost += c;
+        max_cost = std::max(max_cost, c);
+    }
+    const Long min_load = std::max(max_cost, (tot_cost+nprocs-1)/nprocs);
+    const Real max_eff = static_cast<Real>(tot_cost) /
+        (static_cast<Real>(nprocs)*static_cast<Real>(min_load));
+    if (eff >= keep_eff*max_eff) { return r; }
+
+    DistributionMapping new_dm(ba);
+    const Real new_eff = efficiency(new_dm);
+
+    return (eff >= keep_eff*new_eff) ? r : new_dm;
+}
+
 }
@@ -60,6 +60,9 @@ IntVect FabArrayBase::comm_tile_size(AMREX_D_DECL(1024000, 1024000, 1024000));
 IntVect FabArrayBase::comm_tile_size(AMREX_D_DECL(1024000, 8, 8));
 #endif
 
+bool    FabArrayBase::fb_persistent_comm = false;
+bool    FabArrayBase::fb_fuse_messages = false;
+
 FabArrayBase::TACache              FabArrayBase::m_TheTileArrayCache;
 FabArrayBase::FBCache              FabArrayBase::m_TheFBCache;
 FabArrayBase::CPCache              FabArrayBase::m_TheCPCache;
@@ -119,6 +122,8 @@ FabArrayBase::Initialize ()
     }
 
     pp.queryAdd("maxcomp",             FabArrayBase::MaxComp);
+    pp.queryAdd("fb_persistent_comm",  FabArrayBase::fb_persistent_comm);
+    pp.queryAdd("fb_fuse_messages",    FabArrayBase::fb_fuse_messages);
 
     if (MaxComp < 1) {
         MaxComp = 1;
@@ -1175,6 +1180,178 @@ FabArrayBase::FB::define_os (const FabArrayBase& fa)
     // due to the way they are built.
 }
 
+#ifdef AMREX_USE_MPI
+namespace {
+    // A dup of ParallelDescriptor::Communicator() used only by persistent
+    // FillBoundary requests, so that their fixed tags cannot match any
+    // other message.  Each PersistentComm on it gets its own tag.
+    MPI_Comm s_persistent_comm = MPI_COMM_NULL;
+    int s_persistent_tag = 0;
+
+    MPI_Request persistent_request (char* buf, std::size_t n, int pid, int tag,
+                                    MPI_Comm comm, bool is_send)
+    {
+        MPI_Datatype datatype;
+        std::size_t nelems;
+        const int comm_data_type = ParallelDescriptor::select_comm_data_type(n);
+        if (comm_data_type == 1) {
+            datatype = ParallelDescriptor::Mpi_typemap<char>::type();
+            nelems = n;
+        } else if (comm_data_type == 2) {
+            datatype = ParallelDescriptor::Mpi_typemap<unsigned long long>::type();
+            nelems = n / sizeof(unsigned long long);
+        } else if (comm_data_type == 3) {
+            datatype = ParallelDescriptor::Mpi_typemap<ParallelDescriptor::lull_t>::type();
+            nelems = n / sizeof(ParallelDescriptor::lull_t);
+        } else {
+            amrex::Abort("FB::PersistentComm: message size is too big");
+            return MPI_REQUEST_NULL;
+        }
+        MPI_Request req;
+        if (is_send) {
+            BL_MPI_REQUIRE( MPI_Send_init(buf, static_cast<int>(nelems), datatype,
+                                          pid, tag, comm, &req) );
+        } else {
+            BL_MPI_REQUIRE( MPI_Recv_init(buf, static_cast<int>(nelems), datatype,
+                                          pid, tag, comm, &req) );
+        }
+        return req;
+    }
+}
+#endif
+
+FabArrayBase::FB::PersistentComm::~PersistentComm ()
+{
+#ifdef AMREX_USE_MPI
+    for (auto& req : m_recv_reqs) {
+        if (req != MPI_REQUEST_NULL) { MPI_Request_free(&req); }
+    }
+    for (auto& req : m_send_reqs) {
+        if (req != MPI_REQUEST_NULL) { MPI_Request_free(&req); }
+    }
+    if (m_own_comm) { MPI_Comm_free(&m_mpi_comm); }
+#endif
+    if (m_the_recv_data) { The_Comms_Arena()->free(m_the_recv_data); }
+    if (m_the_send_data) { The_Comms_Arena()->free(m_the_send_data); }
+}
+
+void
+FabArrayBase::FB::PersistentComm::startRecvs ()
+{
+#ifdef AMREX_USE_MPI
+    for (auto& req : m_recv_reqs) {
+        if (req != MPI_REQUEST_NULL) { BL_MPI_REQUIRE( MPI_Start(&req) ); }
+    }
+#endif
+}
+
+void
+FabArrayBase::FB::PersistentComm::startSends ()
+{
+#ifdef AMREX_USE_MPI
+    for (auto& req : m_send_reqs) {
+        if (req != MPI_REQUEST_NULL) { BL_MPI_REQUIRE( MPI_Start(&req) ); }
+    }
+#endif
+}
+
+FabArrayBase::FB::PersistentComm&
+FabArrayBase::FB::getPersistentComm (int ncomp, std::size_t sizeof_buf,
+                                     std::size_t alignof_buf) const
+{
+    MPI_Comm comm = ParallelContext::CommunicatorSub();
+
+    for (auto const& pc : m_persistent_comm) {
+        if (!pc->m_in_use && pc->m_ncomp == ncomp && pc->m_sizeof_buf == sizeof_buf
+            && pc->m_comm == comm)
+        {
+            return *pc;
+        }
+    }
+
+    BL_PROFILE("FB::getPersistentComm()");
+
+    auto pc = std::make_unique<PersistentComm>();
+    pc->m_ncomp = ncomp;
+    pc->m_sizeof_buf = sizeof_buf;
+    pc->m_comm = comm;
+
+#ifdef AMREX_USE_MPI
+    // The messages go through a dup'd communicator, either the one shared
+    // by all PersistentComms on ParallelDescriptor::Communicator() with a
+    // tag for each, or a private one for any other communicator.
+    if (comm == ParallelDescriptor::Communicator()) {
+        if (s_persistent_comm == MPI_COMM_NULL) {
+            BL_MPI_REQUIRE( MPI_Comm_dup(comm, &s_persistent_comm) );
+        }
+        pc->m_mpi_comm = s_persistent_comm;
+        pc->m_tag = s_persistent_tag;
+        s_persistent_tag = (s_persistent_tag < ParallelDescriptor::MaxTag()) ?
+            s_persistent_tag+1 : 0;
+    } else {
+        BL_MPI_REQUIRE( MPI_Comm_dup(comm, &pc->m_mpi_comm) );
+        pc->m_own_comm = true;
+        pc->m_tag = 0;
+    }
+
+    // The layout of the buffers is the same as in FabArray::PostRcvs and
+    // FabArray::PrepareSendBuffers.
+    auto layout = [&] (MapOfCopyComTagContainers const& tags, bool is_send,
+                       char*& the_data, Vector<char*>& data, Vector<std::size_t>& size,
+                       Vector<int>& rank, Vector<MPI_Request>& reqs)
+    {
+        Vector<std::size_t> offset;
+        std::size_t total_volume = 0;
+        for (auto const& kv : tags)
+        {
+            std::size_t nbytes = 0;
+            for (auto const& cct : kv.second)
+            {
+                nbytes += (is_send ? cct.sbox : cct.dbox).numPts() * ncomp * sizeof_buf;
+            }
+
+            std::size_t acd = ParallelDescriptor::sizeof_selected_comm_data_type(nbytes);
+            nbytes = amrex::aligned_size(acd, nbytes);
+
+            total_volume = amrex::aligned_size(std::max(alignof_buf, acd), total_volume);
+
+            offset.push_back(total_volume);
+            total_volume += nbytes;
+
+            data.push_back(nullptr);
+            size.push_back(nbytes);
+            rank.push_back(kv.first);
+            reqs.push_back(MPI_REQUEST_NULL);
+            if (is_send) { pc->m_send_cctc.push_back(&(kv.second)); }
+        }
+
+        if (total_volume > 0) {
+            the_data = static_cast<char*>(The_Comms_Arena()->alloc(total_volume));
+            for (int i = 0, N = static_cast<int>(size.size()); i < N; ++i) {
+                data[i] = the_data + offset[i];
+                if (size[i] > 0) {
+                    reqs[i] = persistent_request(data[i], size[i],
+                                                 ParallelContext::global_to_local_rank(rank[i]),
+                                                 pc->m_tag, pc->m_mpi_comm, is_send);
+                }
+            }
+        }
+    };
+
+    layout(*m_RcvTags, false, pc->m_the_recv_data, pc->m_recv_data, pc->m_recv_size,
+           pc->m_recv_from, pc->m_recv_reqs);
+    layout(*m_SndTags, true , pc->m_the_send_data, pc->m_send_data, pc->m_send_size,
+           pc->m_send_rank, pc->m_send_reqs);
+    pc->m_recv_stat.resize(pc->m_recv_reqs.size());
+    pc->m_send_stat.resize(pc->m_send_reqs.size());
+#else
+    amrex::ignore_unused(alignof_buf);
+#endif
+
+    m_persistent_comm.push_back(std::move(pc));
+    return *m_persistent_comm.back();
+}
+
 void
 FabArrayBase::flushFB (bool no_assertion) const
 {
@@ -2205,6 +2382,12 @@ void
 FabArrayBase::Finalize ()
 {
     FabArrayBase::flushFBCache();
+#ifdef AMREX_USE_MPI
+    if (s_persistent_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&s_persistent_comm);
+    }
+    s_persistent_tag = 0;
+#endif
     FabArrayBase::flushCPCache();
     FabArrayBase::flushRB90Cache();
     FabArrayBase::flushRB180Cache();
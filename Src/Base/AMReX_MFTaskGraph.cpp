@@ -0,0 +1,366 @@
+#include <AMReX_MFTaskGraph.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_ParallelContext.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <algorithm>
+#include <thread>
+
+namespace amrex {
+
+int
+MFTaskGraph::fabArrayId (FabArrayBase const& fa)
+{
+    auto it = std::find(m_fabarrays.begin(), m_fabarrays.end(), &fa);
+    if (it != m_fabarrays.end()) {
+        return static_cast<int>(it - m_fabarrays.begin());
+    }
+    if (!m_fabarrays.empty()) {
+        FabArrayBase const& fa0 = *m_fabarrays[0];
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fa.boxArray().CellEqual(fa0.boxArray()) &&
+                                         fa.DistributionMap() == fa0.DistributionMap(),
+                                         "MFTaskGraph: FabArrays must have the same BoxArray and DistributionMapping");
+    }
+    m_fabarrays.push_back(&fa);
+    return static_cast<int>(m_fabarrays.size()) - 1;
+}
+
+void
+MFTaskGraph::addAccess (int task, int fa, int li, Box const& region, bool write)
+{
+    // Tasks are created in program order, so a task depends on every earlier
+    // task that touches the same cells unless both only read them.
+    auto& accesses = m_accesses[std::make_pair(fa,li)];
+    for (auto const& a : accesses) {
+        if ((write || a.write) && a.task != task && a.region.intersects(region)) {
+            auto& succs = m_tasks[a.task].succs;
+            if (succs.empty() || succs.back() != task) {
+                succs.push_back(task);
+                ++m_tasks[task].npreds;
+            }
+        }
+    }
+    accesses.push_back(Access{task, region, write});
+}
+
+void
+MFTaskGraph::build ()
+{
+    BL_PROFILE("MFTaskGraph::build()");
+
+    auto make_task = [&] (TaskType type, int s) -> int
+    {
+        Task t;
+        t.type = type;
+        t.stage = s;
+        m_tasks.push_back(std::move(t));
+        return static_cast<int>(m_tasks.size()) - 1;
+    };
+
+    const auto nstages = static_cast<int>(m_stages.size());
+    for (int s = 0; s < nstages; ++s)
+    {
+        Stage const& stage = m_stages[s];
+
+        if (stage.fb)
+        {
+            FabArrayBase const& in = *m_fabarrays[stage.in];
+            auto const& fb = *stage.fb;
+
+            for (auto const& kv : *fb.m_SndTags) {
+                std::size_t nbytes = 0;
+                for (auto const& tag : kv.second) {
+                    nbytes += tag.sbox.numPts() * stage.cell_bytes;
+                }
+                if (nbytes == 0) { continue; }
+                int t = make_task(TaskType::send, s);
+                m_tasks[t].msg = static_cast<int>(m_sends.size());
+                m_sends.push_back(Message{s, kv.first, &kv.second, Vector<char>(nbytes), t});
+                for (auto const& tag : kv.second) {
+                    addAccess(t, stage.in, in.localindex(tag.srcIndex), tag.sbox, false);
+                }
+            }
+
+            for (auto const& tag : *fb.m_LocTags) {
+                int t = make_task(TaskType::local_copy, s);
+                m_tasks[t].tag = &tag;
+                addAccess(t, stage.in, in.localindex(tag.srcIndex), tag.sbox, false);
+                addAccess(t, stage.in, in.localindex(tag.dstIndex), tag.dbox, true);
+            }
+
+            for (auto const& kv : *fb.m_RcvTags) {
+                std::size_t nbytes = 0;
+                for (auto const& tag : kv.second) {
+                    nbytes += tag.dbox.numPts() * stage.cell_bytes;
+                }
+                if (nbytes == 0) { continue; }
+                int t = make_task(TaskType::recv, s);
+                m_tasks[t].msg = static_cast<int>(m_recvs.size());
+                m_recvs.push_back(Message{s, kv.first, &kv.second, Vector<char>(nbytes), t});
+                for (auto const& tag : kv.second) {
+                    addAccess(t, stage.in, in.localindex(tag.dstIndex), tag.dbox, true);
+                }
+            }
+        }
+
+        FabArrayBase const& out = *m_fabarrays[stage.out];
+        for (MFIter mfi(out,true); mfi.isValid(); ++mfi)
+        {
+            int t = make_task(TaskType::compute, s);
+            const int li = mfi.LocalIndex();
+            Box const& tbx = mfi.tilebox();
+            m_tasks[t].box = li;
+            m_tasks[t].tile = tbx;
+            if (stage.in >= 0) {
+                FabArrayBase const& in = *m_fabarrays[stage.in];
+                addAccess(t, stage.in, li,
+                          amrex::grow(amrex::convert(tbx,in.ixType()),stage.nghost), false);
+            }
+            for (int r : stage.reads) {
+                addAccess(t, r, li, amrex::convert(tbx,m_fabarrays[r]->ixType()), false);
+            }
+            addAccess(t, stage.out, li, tbx, true);
+        }
+    }
+
+    m_accesses.clear();
+
+    const auto ntasks = static_cast<int>(m_tasks.size());
+    m_ndeps = std::make_unique<std::atomic<int>[]>(ntasks);
+
+    m_built = true;
+}
+
+void
+MFTaskGraph::runInOrder ()
+{
+    for (auto const& stage : m_stages) {
+        if (stage.fill_boundary) {
+            stage.fill_boundary();
+        }
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(*m_fabarrays[stage.out],TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            stage.kernel(mfi.LocalIndex(), mfi.tilebox());
+        }
+    }
+}
+
+void
+MFTaskGraph::release (int task, int tid)
+{
+    if (m_ndeps[task].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        auto& q = m_queues[tid];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(task);
+    }
+}
+
+int
+MFTaskGraph::popTask (int tid)
+{
+    {
+        // Own queue first, last in first out for cache reuse
+        auto& q = m_queues[tid];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            int t = q.tasks.back();
+            q.tasks.pop_back();
+            return t;
+        }
+    }
+    for (int i = 1; i < m_nqueues; ++i) {
+        // Steal the oldest task of another thread
+        auto& q = m_queues[(tid+i) % m_nqueues];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            int t = q.tasks.front();
+            q.tasks.pop_front();
+            return t;
+        }
+    }
+    return -1;
+}
+
+void
+MFTaskGraph::execute (int task, int tid)
+{
+    Task const& t = m_tasks[task];
+    Stage const& stage = m_stages[t.stage];
+
+    switch (t.type)
+    {
+    case TaskType::compute:
+    {
+        stage.kernel(t.box, t.tile);
+        break;
+    }
+    case TaskType::local_copy:
+    {
+        stage.local_copy(*t.tag);
+        break;
+    }
+    case TaskType::send:
+    {
+        auto& msg = m_sends[t.msg];
+        char* p = msg.buffer.data();
+        for (auto const& tag : *msg.tags) {
+            p += stage.pack(tag, p);
+        }
+        std::lock_guard<std::mutex> lock(m_send_mutex);
+        m_ready_sends.push_back(t.msg);
+        break;
+    }
+    case TaskType::recv:
+    {
+        auto const& msg = m_recvs[t.msg];
+        char const* p = msg.buffer.data();
+        for (auto const& tag : *msg.tags) {
+            p += stage.unpack(tag, p);
+        }
+        break;
+    }
+    }
+
+    for (int s : t.succs) {
+        release(s, tid);
+    }
+    m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void
+MFTaskGraph::progressComm (bool wait)
+{
+#ifdef AMREX_USE_MPI
+    MPI_Comm comm = ParallelContext::CommunicatorSub();
+
+    Vector<int> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_send_mutex);
+        std::swap(ready, m_ready_sends);
+    }
+    for (int i : ready) {
+        auto& msg = m_sends[i];
+        const int rank = ParallelContext::global_to_local_rank(msg.rank);
+        m_send_reqs[i] = ParallelDescriptor::Asend(msg.buffer.data(), msg.buffer.size(), rank,
+                                                   m_stages[msg.stage].seqnum, comm).req();
+    }
+
+    if (m_num_recvs_pending > 0) {
+        const auto nrecvs = static_cast<int>(m_recv_reqs.size());
+        Vector<int> indices(nrecvs);
+        int nready = 0;
+        if (wait) {
+            MPI_Waitsome(nrecvs, m_recv_reqs.data(), &nready, indices.data(), MPI_STATUSES_IGNORE);
+        } else {
+            MPI_Testsome(nrecvs, m_recv_reqs.data(), &nready, indices.data(), MPI_STATUSES_IGNORE);
+        }
+        if (nready != MPI_UNDEFINED) {
+            m_num_recvs_pending -= nready;
+            for (int i = 0; i < nready; ++i) {
+                release(m_recvs[indices[i]].task, 0);
+            }
+        }
+    }
+#else
+    amrex::ignore_unused(wait);
+#endif
+}
+
+void
+MFTaskGraph::run ()
+{
+    BL_PROFILE("MFTaskGraph::run()");
+
+    if (m_stages.empty()) { return; }
+
+    if (Gpu::inLaunchRegion()) {
+        runInOrder();
+        return;
+    }
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!OpenMP::in_parallel(),
+                                     "MFTaskGraph::run() cannot be called in an OpenMP parallel region");
+
+#if defined(AMREX_USE_MPI) && defined(AMREX_USE_OMP)
+    // The master thread makes MPI calls while the other threads run tasks.
+    // The thread support level is the same on all processes, so they all
+    // take the same path.
+    if (ParallelContext::NProcsSub() > 1) {
+        int provided = -1;
+        MPI_Query_thread(&provided);
+        if (provided < MPI_THREAD_FUNNELED) {
+            runInOrder();
+            return;
+        }
+    }
+#endif
+
+    if (!m_built) { build(); }
+
+    const auto ntasks = static_cast<int>(m_tasks.size());
+    for (int i = 0; i < ntasks; ++i) {
+        // A receive also waits for its message.
+        int n = m_tasks[i].npreds + ((m_tasks[i].type == TaskType::recv) ? 1 : 0);
+        m_ndeps[i].store(n, std::memory_order_relaxed);
+    }
+    m_remaining.store(ntasks);
+
+    m_nqueues = OpenMP::get_max_threads();
+    m_queues = std::make_unique<TaskQueue[]>(m_nqueues);
+    for (int i = 0, iq = 0; i < ntasks; ++i) {
+        if (m_ndeps[i].load(std::memory_order_relaxed) == 0) {
+            m_queues[iq].tasks.push_back(i);
+            iq = (iq+1) % m_nqueues;
+        }
+    }
+
+#ifdef AMREX_USE_MPI
+    MPI_Comm comm = ParallelContext::CommunicatorSub();
+    m_send_reqs.assign(m_sends.size(), MPI_REQUEST_NULL);
+    m_recv_reqs.assign(m_recvs.size(), MPI_REQUEST_NULL);
+    for (int i = 0, N = static_cast<int>(m_recvs.size()); i < N; ++i) {
+        auto& msg = m_recvs[i];
+        const int rank = ParallelContext::global_to_local_rank(msg.rank);
+        m_recv_reqs[i] = ParallelDescriptor::Arecv(msg.buffer.data(), msg.buffer.size(), rank,
+                                                   m_stages[msg.stage].seqnum, comm).req();
+    }
+    m_num_recvs_pending = static_cast<int>(m_recvs.size());
+#endif
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel num_threads(m_nqueues)
+#endif
+    {
+        // All MPI calls are made by the master thread.
+        const int tid = OpenMP::get_thread_num();
+        while (m_remaining.load(std::memory_order_acquire) > 0) {
+            if (tid == 0) {
+                progressComm(false);
+            }
+            int t = popTask(tid);
+            if (t >= 0) {
+                execute(t, tid);
+            } else if (tid == 0 && m_nqueues == 1) {
+                // Nothing else can make progress.
+                progressComm(true);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+#ifdef AMREX_USE_MPI
+    progressComm(false);
+    if (!m_send_reqs.empty()) {
+        Vector<MPI_Status> stats(m_send_reqs.size());
+        ParallelDescriptor::Waitall(m_send_reqs, stats);
+    }
+#endif
+
+    m_queues.reset();
+}
+
+}
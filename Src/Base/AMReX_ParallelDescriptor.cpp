@@ -68,6 +68,7 @@ namespace amrex::ParallelDescriptor {
 
     int m_nprocs_per_node = 1;
     int m_rank_in_node = 0;
+    int m_node_leader = 0;
 
     int m_nprocs_per_processor = 1;
     int m_rank_in_processor = 0;
@@ -297,6 +298,11 @@ StartParallel (int* argc, char*** argv, MPI_Comm a_mpi_comm)
         int provided = -1;
 
         MPI_Init_thread(argc, argv, requested, &provided);
+#elif defined(AMREX_USE_OMP)
+        // MFTaskGraph makes MPI calls from the master thread in OpenMP
+        // parallel regions.
+        int provided = -1;
+        MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &provided);
 #else //
         MPI_Init(argc, argv);
 #endif
@@ -342,6 +348,15 @@ StartParallel (int* argc, char*** argv, MPI_Comm a_mpi_comm)
         MPI_Comm_split_type(m_comm, split_type, 0, MPI_INFO_NULL, &node_comm);
         MPI_Comm_size(node_comm, &m_nprocs_per_node);
         MPI_Comm_rank(node_comm, &m_rank_in_node);
+        {
+            MPI_Group node_group, group;
+            MPI_Comm_group(node_comm, &node_group);
+            MPI_Comm_group(m_comm, &group);
+            int node_rank0 = 0;
+            MPI_Group_translate_ranks(node_group, 1, &node_rank0, group, &m_node_leader);
+            MPI_Group_free(&node_group);
+            MPI_Group_free(&group);
+        }
         MPI_Comm_free(&node_comm);
 
         char procname[MPI_MAX_PROCESSOR_NAME];
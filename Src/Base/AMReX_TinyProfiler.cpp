@@ -29,6 +29,7 @@ std::vector<TinyProfiler::aligned_deque> TinyProfiler::mem_stack_thread_private;
 #endif
 std::vector<std::map<std::string, MemStat>*> TinyProfiler::all_memstats;
 std::vector<std::string> TinyProfiler::all_memnames;
+std::vector<std::function<MemCacheStat()>> TinyProfiler::all_memcachestats;
 
 std::vector<std::string>          TinyProfiler::regionstack;
 std::deque<std::tuple<double,double,std::string*> > TinyProfiler::ttstack;
@@ -380,20 +381,26 @@ TinyProfiler::MemoryFinalize (bool bFlushing) noexcept
 
     for (std::size_t i = 0; i < all_memstats.size(); ++i) {
         PrintMemStats(*(all_memstats[i]), all_memnames[i], dt_max, t_final);
+        if (all_memcachestats[i]) {
+            PrintMemCacheStats(all_memcachestats[i](), all_memnames[i]);
+        }
     }
 
     if (!bFlushing) {
         all_memstats.clear();
         all_memnames.clear();
+        all_memcachestats.clear();
     }
 }
 
 void
 TinyProfiler::RegisterArena (const std::string& memory_name,
-                             std::map<std::string, MemStat>& memstats) noexcept
+                             std::map<std::string, MemStat>& memstats,
+                             std::function<MemCacheStat()> cache_stat) noexcept
 {
     all_memstats.push_back(&memstats);
     all_memnames.push_back(memory_name);
+    all_memcachestats.push_back(std::move(cache_stat));
 }
 
 void
@@ -403,6 +410,7 @@ TinyProfiler::DeregisterArena (std::map<std::string, MemStat>& memstats) noexcep
         if (all_memstats[i] == &memstats) {
             all_memstats.erase(all_memstats.begin() + i); // NOLINT
             all_memnames.erase(all_memnames.begin() + i); // NOLINT
+            all_memcachestats.erase(all_memcachestats.begin() + i); // NOLINT
         } else {
             ++i;
         }
@@ -790,6 +798,23 @@ TinyProfiler::PrintMemStats(std::map<std::string, MemStat>& memstats,
     amrex::OutStream() << hline << "\n\n";
 }
 
+void
+TinyProfiler::PrintMemCacheStats (MemCacheStat stat, std::string const& memname)
+{
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    ParallelReduce::Sum<Long>({stat.nhit, stat.nmiss}, ioproc,
+                              ParallelDescriptor::Communicator());
+
+    const Long ntot = stat.nhit + stat.nmiss;
+    if (ntot == 0) { return; }
+
+    amrex::Print() << memname << " Thread Cache: " << stat.nhit << " hits, "
+                   << stat.nmiss << " misses, hit rate "
+                   << std::fixed << std::setprecision(2)
+                   << 100.*static_cast<double>(stat.nhit)/static_cast<double>(ntot)
+                   << "%\n\n";
+}
+
 void
 TinyProfiler::StartRegion (std::string regname) noexcept
 {
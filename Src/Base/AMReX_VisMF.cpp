@@ -4,6 +4,7 @@
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
 #include <AMReX_VisMF.H>
+#include <AMReX_VisMFCompress.H>
 
 #include <cerrno>
 #include <cstdio>
@@ -30,6 +31,8 @@ bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
 bool VisMF::allowSparseWrites(true);
+Real VisMF::compressionTolerance(0.0);
+Long VisMF::compressionChunkSize(131072);
 
 Long VisMFBuffer::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -95,6 +98,8 @@ VisMF::Initialize ()
     pp.queryAdd("usedynamicsetselection", useDynamicSetSelection);
     pp.queryAdd("iobuffersize", ioBufferSize);
     pp.queryAdd("allowsparsewrites", allowSparseWrites);
+    pp.queryAdd("compressiontolerance", compressionTolerance);
+    pp.queryAdd("compressionchunksize", compressionChunkSize);
 
     initialized = true;
 }
@@ -301,7 +306,9 @@ operator<< (std::ostream        &os,
       os << hd.m_max      << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
+    {
       BL_ASSERT(hd.m_famin.size() == hd.m_ncomp);
       BL_ASSERT(hd.m_famin.size() == hd.m_famax.size());
       for(auto famin : hd.m_famin) {
@@ -314,9 +321,10 @@ operator<< (std::ostream        &os,
       os << '\n';
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
         os << FPC::NativeRealDescriptor() << '\n';
@@ -387,7 +395,9 @@ operator>> (std::istream  &is,
       BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
     }
 
-    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
+    if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
+    {
       char ch;
       AMREX_ASSERT(hd.m_ncomp >= 0 && hd.m_ncomp < std::numeric_limits<int>::max());
       hd.m_famin.resize(hd.m_ncomp);
@@ -405,9 +415,10 @@ operator>> (std::istream  &is,
         }
       }
     }
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    if(hd.m_vers == VisMF::Header::NoFabHeader_v1         ||
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1   ||
+       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+       hd.m_vers == VisMF::Header::Compressed_v1)
     {
       is >> hd.m_writtenRD;
     }
@@ -666,7 +677,7 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
         && (mf.arena()->isManaged() || mf.arena()->isDevice());
     amrex::ignore_unused(run_on_device);
 
-    if(version == NoFabHeaderFAMinMax_v1) {
+    if(version == NoFabHeaderFAMinMax_v1 || version == Compressed_v1) {
       // ---- calculate FabArray min max values only
       m_min.clear();
       m_max.clear();
@@ -999,6 +1010,34 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     NFilesIter nfi(nOutFiles, filePrefix, groupSets, setBuf);
 
     bool oldHeader(currentVersion == VisMF::Header::Version_v1);
+    bool compressed(currentVersion == VisMF::Header::Compressed_v1);
+
+    // ---- compress before the write sets so the writers are not held up
+    Vector<Long> fabBytes;
+    Vector<Vector<char> > compressedFabs;
+    if(compressed) {
+        BL_PROFILE("VisMF::Write:compress");
+        fabBytes.resize(mf.size(), 0);
+        for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            const FArrayBox &fab = mf[mfi];
+            Real const* fabdata = fab.dataPtr();
+#ifdef AMREX_USE_GPU
+            std::unique_ptr<FArrayBox> hostfab;
+            if (fab.arena()->isManaged() || fab.arena()->isDevice()) {
+                hostfab = std::make_unique<FArrayBox>(fab.box(), fab.nComp(),
+                                                      The_Pinned_Arena());
+                Gpu::dtoh_memcpy_async(hostfab->dataPtr(), fab.dataPtr(),
+                                       fab.size()*sizeof(Real));
+                Gpu::streamSynchronize();
+                fabdata = hostfab->dataPtr();
+            }
+#endif
+            compressedFabs.emplace_back();
+            VisMFCompress::Compress(compressedFabs.back(), fabdata, fab.box().numPts() * mf.nComp(),
+                                    *whichRD, compressionChunkSize, compressionTolerance);
+            fabBytes[mfi.index()] = static_cast<Long>(compressedFabs.back().size());
+        }
+    }
 
     if(useSparseFPP) {
         nfi.SetSparseFPP(procsWithDataVector);
@@ -1006,6 +1045,14 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         nfi.SetDynamic();
     }
     for( ; nfi.ReadyToWrite(); ++nfi) {
+        if(compressed) {
+            for(auto const& cfab : compressedFabs) {
+                nfi.Stream().write(cfab.dataPtr(), static_cast<std::streamsize>(cfab.size()));
+                bytesWritten += static_cast<Long>(cfab.size());
+            }
+            nfi.Stream().flush();
+            continue;
+        }
         // ---- find the total number of bytes including fab headers if needed
         const FABio &fio = FArrayBox::getFABio();
         int whichRDBytes(whichRD->numBytes()), nFABs(0);
@@ -1123,8 +1170,13 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         hdr.CalculateMinMax(mf, coordinatorProc);
     }
 
+    if(compressed) {
+        ParallelDescriptor::ReduceLongSum(fabBytes.dataPtr(), static_cast<int>(fabBytes.size()),
+                                          coordinatorProc);
+    }
+
     VisMF::FindOffsets(mf, filePrefix, hdr, currentVersion, nfi,
-                       ParallelDescriptor::Communicator());
+                       ParallelDescriptor::Communicator(), fabBytes);
 
     bytesWritten += VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
 
@@ -1171,7 +1223,8 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
                     const std::string &filePrefix,
                     VisMF::Header &hdr,
                     VisMF::Header::Version /*whichVersion*/,
-                    NFilesIter &nfi, MPI_Comm comm)
+                    NFilesIter &nfi, MPI_Comm comm,
+                    const Vector<Long> &fabBytes)
 {
 //    BL_PROFILE("VisMF::FindOffsets");
 
@@ -1312,8 +1365,12 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
               for(int i : index) {
                  hdr.m_fod[i].m_name = whichFileName;
                  hdr.m_fod[i].m_head = currentOffset[whichFileNumber];
-                 currentOffset[whichFileNumber] += mf.fabbox(i).numPts() * nComps * whichRDBytes
-                                                   + fabHeaderBytes[i];
+                 if(fabBytes.empty()) {
+                   currentOffset[whichFileNumber] += mf.fabbox(i).numPts() * nComps * whichRDBytes
+                                                     + fabHeaderBytes[i];
+                 } else {
+                   currentOffset[whichFileNumber] += fabBytes[i];
+                 }
               }
             }
           }
@@ -1404,6 +1461,24 @@ VisMF::readFAB (int                  idx,
       } else {
         fab->readFrom(*infs, whichComp);
       }
+    } else if(hdr.m_vers == Header::Compressed_v1) {
+      Real* fabdata = fab->dataPtr();
+#ifdef AMREX_USE_GPU
+      std::unique_ptr<FArrayBox> hostfab;
+      if (fab->arena()->isManaged() || fab->arena()->isDevice()) {
+          hostfab = std::make_unique<FArrayBox>(fab->box(), fab->nComp(), The_Pinned_Arena());
+          fabdata = hostfab->dataPtr();
+      }
+#endif
+      Long readDataItems(fab->box().numPts() * fab->nComp());
+      Long firstItem(whichComp == -1 ? 0 : fab->box().numPts() * whichComp);
+      VisMFCompress::Decompress(fabdata, *infs, firstItem, readDataItems, hdr.m_writtenRD);
+#ifdef AMREX_USE_GPU
+      if (hostfab) {
+          Gpu::htod_memcpy_async(fab->dataPtr(), hostfab->dataPtr(), fab->size()*sizeof(Real));
+          Gpu::streamSynchronize();
+      }
+#endif
     } else {
       Real* fabdata = fab->dataPtr();
 #ifdef AMREX_USE_GPU
@@ -1462,7 +1537,7 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
+    if(NoFabHeader(hdr) || hdr.m_vers == Header::Compressed_v1) {
       Real* fabdata = fab.dataPtr();
 #ifdef AMREX_USE_GPU
       std::unique_ptr<FArrayBox> hostfab;
@@ -1471,7 +1546,10 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
           fabdata = hostfab->dataPtr();
       }
 #endif
-      if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
+      if(hdr.m_vers == Header::Compressed_v1) {
+        VisMFCompress::Decompress(fabdata, *infs, 0, fab.box().numPts() * fab.nComp(),
+                                  hdr.m_writtenRD);
+      } else if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
         infs->read((char *) fabdata, static_cast<std::streamsize>(fab.nBytes()));
       } else {
         Long readDataItems(fab.box().numPts() * fab.nComp());
@@ -2271,7 +2349,11 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
 
     RealDescriptor const& whichRD = FPC::NativeRealDescriptor();
 
-    auto hdr = std::make_shared<VisMF::Header>(mf, VisMF::NFiles, VisMF::Header::Version_v1, false);
+    // ---- the other versions are written as Version_v1
+    const bool compressed = (currentVersion == VisMF::Header::Compressed_v1);
+    auto hdr = std::make_shared<VisMF::Header>(mf, VisMF::NFiles,
+                                               compressed ? VisMF::Header::Compressed_v1
+                                                          : VisMF::Header::Version_v1, false);
     if (valid_cells_only) { hdr->m_ngrow = IntVect(0); }
 
     constexpr int sizeof_int64_over_real = sizeof(int64_t) / sizeof(Real);
@@ -2290,11 +2372,44 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
 
     bool strip_ghost = valid_cells_only && mf.nGrowVect() != 0;
 
+    // ---- compress now, because the offsets depend on the compressed sizes
+    auto compressedFabs = std::make_shared<Vector<Vector<char> > >();
+    if (compressed) {
+        BL_PROFILE("VisMF::AsyncWrite:compress");
+        auto writeRD = FArrayBox::getDataDescriptor();
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
+            Real const* fabdata = mf[mfi].dataPtr();
+            FArrayBox hostfab;
+#ifdef AMREX_USE_GPU
+            if (data_on_device) {
+                hostfab.resize(bx, ncomp, The_Pinned_Arena());
+                if (strip_ghost) {
+                    hostfab.copy<RunOn::Device>(mf[mfi], bx);
+                } else {
+                    Gpu::dtoh_memcpy_async(hostfab.dataPtr(), mf[mfi].dataPtr(), hostfab.size()*sizeof(Real));
+                }
+                Gpu::streamSynchronize();
+                fabdata = hostfab.dataPtr();
+            } else
+#endif
+            if (strip_ghost) {
+                hostfab.resize(bx, ncomp, The_Pinned_Arena());
+                hostfab.copy<RunOn::Host>(mf[mfi], bx);
+                fabdata = hostfab.dataPtr();
+            }
+            compressedFabs->emplace_back();
+            VisMFCompress::Compress(compressedFabs->back(), fabdata, bx.numPts() * ncomp,
+                                    *writeRD, compressionChunkSize, compressionTolerance);
+        }
+    }
+
     int64_t total_bytes = 0;
     if (localdata.size() > 1) {
         char* pld = (char*)(&(localdata[1]));
         const FABio& fio = FArrayBox::getFABio();
-        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        int lidx = 0;
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi, ++lidx)
         {
             std::memcpy(pld, &total_bytes, sizeof(int64_t));
             pld += sizeof(int64_t);
@@ -2302,12 +2417,16 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
             const FArrayBox& fab = mf[mfi];
             const Box& bx = mfi.validbox();
 
-            std::stringstream hss;
-            FArrayBox valid_fab(bx, ncomp, false);
-            FArrayBox const& header_fab = (strip_ghost) ? valid_fab : fab;
-            fio.write_header(hss, header_fab, ncomp);
-            total_bytes += static_cast<std::streamoff>(hss.tellp());
-            total_bytes += header_fab.size() * whichRD.numBytes();
+            if (compressed) {
+                total_bytes += static_cast<int64_t>((*compressedFabs)[lidx].size());
+            } else {
+                std::stringstream hss;
+                FArrayBox valid_fab(bx, ncomp, false);
+                FArrayBox const& header_fab = (strip_ghost) ? valid_fab : fab;
+                fio.write_header(hss, header_fab, ncomp);
+                total_bytes += static_cast<std::streamoff>(hss.tellp());
+                total_bytes += header_fab.size() * whichRD.numBytes();
+            }
 
             // compute min and max
             for (int icomp = 0; icomp < ncomp; ++icomp) {
@@ -2354,8 +2473,22 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
     }
 #endif
 
+    // ---- wait for earlier jobs to free enough staging memory
+    Long staged_bytes = 0;
+    if (compressed) {
+        for (auto const& cfab : *compressedFabs) {
+            staged_bytes += static_cast<Long>(cfab.size());
+        }
+    } else {
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
+            staged_bytes += bx.numPts() * ncomp * static_cast<Long>(sizeof(Real));
+        }
+    }
+    AsyncOut::Reserve(staged_bytes);
+
     auto myfabs = std::make_shared<Vector<FArrayBox> >();
-    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+    for (MFIter mfi(mf); mfi.isValid() && !compressed; ++mfi) {
         Box bx = strip_ghost ? mfi.validbox() : mfi.fabbox();
 #ifdef AMREX_USE_GPU
         if (data_on_device) {
@@ -2372,7 +2505,7 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
             if (is_rvalue && ! strip_ghost) {
                 myfabs->emplace_back(std::move(const_cast<FArrayBox&>(mf[mfi])));
             } else {
-                myfabs->emplace_back(bx, mf.nComp(), The_Cpu_Arena());
+                myfabs->emplace_back(bx, mf.nComp(), The_Pinned_Arena());
                 auto& new_fab = myfabs->back();
                 new_fab.copy<RunOn::Host>(mf[mfi], bx);
             }
@@ -2468,7 +2601,7 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
         AsyncOut::Wait();  // Wait for my turn
 
         auto info = AsyncOut::GetWriteInfo(myproc);
-        if (! myfabs->empty()) {
+        if (! myfabs->empty() || ! compressedFabs->empty()) {
             std::string file_name = amrex::Concatenate(mf_name + FabFileSuffix, info.ifile, 5);
             std::ofstream ofs;
             ofs.rdbuf()->pubsetbuf(io_buffer.dataPtr(), io_buffer.size());
@@ -2479,11 +2612,18 @@ VisMF::AsyncWriteDoit (const FabArray<FArrayBox>& mf, const std::string& mf_name
                 fabio->write_header(ofs, fab, fab.nComp());
                 fabio->write(ofs, fab, 0, fab.nComp());
             }
+            for (auto const& cfab : *compressedFabs) {
+                ofs.write(cfab.dataPtr(), static_cast<std::streamsize>(cfab.size()));
+            }
             ofs.flush();
             ofs.close();
         }
 
         AsyncOut::Notify();  // Notify others I am done
+
+        myfabs->clear();
+        compressedFabs->clear();
+        AsyncOut::Release(staged_bytes);
     });
 }
 
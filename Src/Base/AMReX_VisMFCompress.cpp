@@ -0,0 +1,421 @@
+
+#include <AMReX_VisMFCompress.H>
+#include <AMReX.H>
+#include <AMReX_FPC.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+
+namespace amrex::VisMFCompress {
+
+namespace {
+
+    constexpr char magic[4] = {'V', 'M', 'Z', '1'};
+    constexpr Long stream_head_bytes = 4 + 3*8;
+
+    enum ChunkKind : unsigned char {
+        Raw       = 0,  // values in the written format
+        ShuffleLZ = 1,  // values in the written format, byte-shuffled, LZ coded
+        Quantized = 2   // zigzag deltas of quantized values, byte-shuffled, LZ coded
+    };
+
+    // Integers in the stream are little endian regardless of the host.
+    void put_u64 (char* p, std::uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i) {
+            p[i] = static_cast<char>((v >> (8*i)) & 0xff);
+        }
+    }
+
+    std::uint64_t get_u64 (char const* p)
+    {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v |= std::uint64_t(static_cast<unsigned char>(p[i])) << (8*i);
+        }
+        return v;
+    }
+
+    // Gather byte b of every value into plane b.  For smooth floating point
+    // data the sign/exponent planes are highly repetitive.
+    void shuffle (unsigned char* AMREX_RESTRICT out, unsigned char const* AMREX_RESTRICT in,
+                  Long n, int w)
+    {
+        for (int b = 0; b < w; ++b) {
+            unsigned char* AMREX_RESTRICT o = out + b*n;
+            for (Long i = 0; i < n; ++i) {
+                o[i] = in[i*w+b];
+            }
+        }
+    }
+
+    void unshuffle (unsigned char* AMREX_RESTRICT out, unsigned char const* AMREX_RESTRICT in,
+                    Long n, int w)
+    {
+        for (int b = 0; b < w; ++b) {
+            unsigned char const* AMREX_RESTRICT p = in + b*n;
+            for (Long i = 0; i < n; ++i) {
+                out[i*w+b] = p[i];
+            }
+        }
+    }
+
+    //
+    // A byte oriented LZ77 coder.  A sequence is a token byte holding the
+    // literal length (high nibble) and the match length minus lz_min_match
+    // (low nibble), optional length extension bytes, the literals, and a
+    // two byte offset followed by optional match length extension bytes.
+    // The last sequence has literals only.
+    //
+    constexpr Long lz_min_match = 4;
+    constexpr Long lz_max_offset = 65535;
+    constexpr int  lz_hash_bits = 14;
+
+    std::uint32_t lz_read32 (unsigned char const* p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    std::uint32_t lz_hash (std::uint32_t v)
+    {
+        return (v * 2654435761U) >> (32 - lz_hash_bits);
+    }
+
+    void lz_put_length (unsigned char* dst, Long& op, Long len)
+    {
+        while (len >= 255) {
+            dst[op++] = 255;
+            len -= 255;
+        }
+        dst[op++] = static_cast<unsigned char>(len);
+    }
+
+    // Returns the compressed size, or -1 if it would exceed cap.
+    Long lz_compress (unsigned char* dst, Long cap, unsigned char const* src, Long n)
+    {
+        Long op = 0;
+
+        auto emit = [&] (Long anchor, Long nlit, Long offset, Long mlen) -> bool
+        {
+            Long need = 1 + (nlit/255 + 1) + nlit + ((mlen > 0) ? 2 + ((mlen-lz_min_match)/255 + 1) : 0);
+            if (op + need > cap) { return false; }
+            Long itoken = op++;
+            auto token = static_cast<unsigned char>(std::min(nlit, Long(15)) << 4);
+            if (nlit >= 15) { lz_put_length(dst, op, nlit-15); }
+            std::memcpy(dst+op, src+anchor, nlit);
+            op += nlit;
+            if (mlen > 0) {
+                dst[op++] = static_cast<unsigned char>(offset & 0xff);
+                dst[op++] = static_cast<unsigned char>(offset >> 8);
+                Long ml = mlen - lz_min_match;
+                token |= static_cast<unsigned char>(std::min(ml, Long(15)));
+                if (ml >= 15) { lz_put_length(dst, op, ml-15); }
+            }
+            dst[itoken] = token;
+            return true;
+        };
+
+        Vector<Long> table(Long(1) << lz_hash_bits, -1);
+        Long ip = 0, anchor = 0, misses = 0;
+        while (ip + lz_min_match <= n) {
+            std::uint32_t seq = lz_read32(src+ip);
+            std::uint32_t h = lz_hash(seq);
+            Long ref = table[h];
+            table[h] = ip;
+            if (ref >= 0 && ip-ref <= lz_max_offset && lz_read32(src+ref) == seq) {
+                Long len = lz_min_match;
+                while (ip+len+8 <= n) {
+                    std::uint64_t a, b;
+                    std::memcpy(&a, src+ref+len, 8);
+                    std::memcpy(&b, src+ip+len, 8);
+                    if (a != b) { break; }
+                    len += 8;
+                }
+                while (ip+len < n && src[ref+len] == src[ip+len]) { ++len; }
+                if (! emit(anchor, ip-anchor, ip-ref, len)) { return -1; }
+                ip += len;
+                anchor = ip;
+                misses = 0;
+            } else {
+                // Skip faster through data that does not compress.
+                ip += 1 + (misses++ >> 6);
+            }
+        }
+        if (! emit(anchor, n-anchor, 0, 0)) { return -1; }
+        return op;
+    }
+
+    bool lz_decompress (unsigned char* dst, Long n, unsigned char const* src, Long m)
+    {
+        Long ip = 0, op = 0;
+        auto get_length = [&] (Long& len) -> bool
+        {
+            unsigned char c;
+            do {
+                if (ip >= m) { return false; }
+                c = src[ip++];
+                len += c;
+            } while (c == 255);
+            return true;
+        };
+
+        while (ip < m) {
+            unsigned char token = src[ip++];
+            Long nlit = token >> 4;
+            if (nlit == 15 && ! get_length(nlit)) { return false; }
+            if (ip+nlit > m || op+nlit > n) { return false; }
+            std::memcpy(dst+op, src+ip, nlit);
+            ip += nlit;
+            op += nlit;
+            if (ip == m) { break; }
+
+            if (ip+2 > m) { return false; }
+            Long offset = Long(src[ip]) | (Long(src[ip+1]) << 8);
+            ip += 2;
+            Long mlen = token & 15;
+            if (mlen == 15 && ! get_length(mlen)) { return false; }
+            mlen += lz_min_match;
+            if (offset == 0 || offset > op || op+mlen > n) { return false; }
+            unsigned char* d = dst + op;
+            unsigned char const* s = d - offset;
+            if (offset >= mlen) {
+                std::memcpy(d, s, mlen);
+            } else {
+                for (Long i = 0; i < mlen; ++i) { d[i] = s[i]; }
+            }
+            op += mlen;
+        }
+        return op == n;
+    }
+
+    // Quantize to multiples of 2*tolerance and code the deltas.  Returns
+    // false if the error bound cannot be met or the result does not compress.
+    bool compress_quantized (Vector<char>& out, Real const* in, Long n, Real tolerance)
+    {
+        const Real step = Real(2.0)*tolerance;
+        // Keep the deltas of two codes from overflowing.
+        const Real qmax = Real(std::uint64_t(1) << 61);
+
+        Vector<unsigned char> zbytes(n*8);
+        std::int64_t qprev = 0;
+        for (Long i = 0; i < n; ++i) {
+            const Real r = in[i] / step;
+            if (! (std::abs(r) < qmax)) { return false; }
+            const auto q = static_cast<std::int64_t>(std::llround(r));
+            const Real x = static_cast<Real>(q) * step;
+            if (! (std::abs(x - in[i]) <= tolerance)) { return false; }
+            const std::int64_t d = q - qprev;
+            qprev = q;
+            const std::uint64_t z = (static_cast<std::uint64_t>(d) << 1)
+                ^ static_cast<std::uint64_t>(d >> 63);
+            put_u64(reinterpret_cast<char*>(zbytes.data()) + i*8, z);
+        }
+
+        Vector<unsigned char> shuffled(n*8);
+        shuffle(shuffled.data(), zbytes.data(), n, 8);
+
+        out.resize(1 + 8 + n*8);
+        out[0] = static_cast<char>(Quantized);
+        std::uint64_t stepbits;
+        auto dstep = static_cast<double>(step);
+        std::memcpy(&stepbits, &dstep, sizeof(stepbits));
+        put_u64(out.data()+1, stepbits);
+        // Only worth it if it beats plain values.
+        Long cap = n*static_cast<Long>(sizeof(Real));
+        Long csize = lz_compress(reinterpret_cast<unsigned char*>(out.data())+9, cap,
+                                 shuffled.data(), n*8);
+        if (csize < 0) { return false; }
+        out.resize(9 + csize);
+        return true;
+    }
+
+    void compress_chunk (Vector<char>& out, Real const* in, Long n,
+                         RealDescriptor const& rd, bool native, Real tolerance)
+    {
+        if (tolerance > Real(0.0) && compress_quantized(out, in, n, tolerance)) {
+            return;
+        }
+
+        const int w = rd.numBytes();
+        const Long nbytes = n*w;
+        Vector<unsigned char> raw(nbytes);
+        if (native) {
+            std::memcpy(raw.data(), in, nbytes);
+        } else {
+            RealDescriptor::convertFromNativeFormat(raw.data(), n, in, rd);
+        }
+
+        Vector<unsigned char> shuffled(nbytes);
+        shuffle(shuffled.data(), raw.data(), n, w);
+
+        out.resize(1 + nbytes);
+        Long csize = lz_compress(reinterpret_cast<unsigned char*>(out.data())+1, nbytes-1,
+                                 shuffled.data(), nbytes);
+        if (csize < 0) {
+            out[0] = static_cast<char>(Raw);
+            std::memcpy(out.data()+1, raw.data(), nbytes);
+        } else {
+            out[0] = static_cast<char>(ShuffleLZ);
+            out.resize(1 + csize);
+        }
+    }
+
+    void decompress_chunk (Real* out, Long n, char const* p, Long m,
+                           RealDescriptor const& rd, bool native)
+    {
+        const int w = rd.numBytes();
+        const Long nbytes = n*w;
+        auto const* src = reinterpret_cast<unsigned char const*>(p);
+        bool ok = (m >= 1);
+
+        if (ok && src[0] == Raw) {
+            ok = (m-1 == nbytes);
+            if (ok) {
+                if (native) {
+                    std::memcpy(out, src+1, nbytes);
+                } else {
+                    RealDescriptor::convertToNativeFormat(out, n, const_cast<unsigned char*>(src+1), rd);
+                }
+            }
+        } else if (ok && src[0] == ShuffleLZ) {
+            Vector<unsigned char> shuffled(nbytes);
+            ok = lz_decompress(shuffled.data(), nbytes, src+1, m-1);
+            if (ok) {
+                if (native) {
+                    unshuffle(reinterpret_cast<unsigned char*>(out), shuffled.data(), n, w);
+                } else {
+                    Vector<unsigned char> raw(nbytes);
+                    unshuffle(raw.data(), shuffled.data(), n, w);
+                    RealDescriptor::convertToNativeFormat(out, n, raw.data(), rd);
+                }
+            }
+        } else if (ok && src[0] == Quantized) {
+            ok = (m >= 9);
+            Vector<unsigned char> shuffled(n*8);
+            if (ok) {
+                ok = lz_decompress(shuffled.data(), n*8, src+9, m-9);
+            }
+            if (ok) {
+                std::uint64_t stepbits = get_u64(p+1);
+                double dstep;
+                std::memcpy(&dstep, &stepbits, sizeof(dstep));
+                const auto step = static_cast<Real>(dstep);
+                Vector<unsigned char> zbytes(n*8);
+                unshuffle(zbytes.data(), shuffled.data(), n, 8);
+                std::int64_t q = 0;
+                for (Long i = 0; i < n; ++i) {
+                    const std::uint64_t z = get_u64(reinterpret_cast<char const*>(zbytes.data()) + i*8);
+                    q += static_cast<std::int64_t>(z >> 1) ^ -static_cast<std::int64_t>(z & 1);
+                    out[i] = static_cast<Real>(q) * step;
+                }
+            }
+        } else {
+            ok = false;
+        }
+
+        if (! ok) {
+            amrex::Error("VisMFCompress::Decompress: corrupted chunk");
+        }
+    }
+}
+
+void
+Compress (Vector<char>& out, Real const* in, Long n,
+          RealDescriptor const& rd, Long chunk_size, Real tolerance)
+{
+    chunk_size = std::max(chunk_size, Long(1));
+    const Long nchunks = (n + chunk_size - 1) / chunk_size;
+    const bool native = (rd == FPC::NativeRealDescriptor());
+
+    Vector<Vector<char> > chunks(nchunks);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for schedule(dynamic) if (nchunks > 1)
+#endif
+    for (Long c = 0; c < nchunks; ++c) {
+        const Long cbeg = c*chunk_size;
+        compress_chunk(chunks[c], in+cbeg, std::min(chunk_size, n-cbeg), rd, native, tolerance);
+    }
+
+    Long total = stream_head_bytes + 8*nchunks;
+    for (auto const& chunk : chunks) {
+        total += static_cast<Long>(chunk.size());
+    }
+    out.resize(total);
+
+    char* p = out.data();
+    std::memcpy(p, magic, 4);
+    put_u64(p+4,  static_cast<std::uint64_t>(n));
+    put_u64(p+12, static_cast<std::uint64_t>(chunk_size));
+    put_u64(p+20, static_cast<std::uint64_t>(nchunks));
+    p += stream_head_bytes;
+    for (auto const& chunk : chunks) {
+        put_u64(p, chunk.size());
+        p += 8;
+    }
+    for (auto const& chunk : chunks) {
+        std::memcpy(p, chunk.data(), chunk.size());
+        p += chunk.size();
+    }
+}
+
+void
+Decompress (Real* out, std::istream& is, Long start, Long n, RealDescriptor const& rd)
+{
+    char head[stream_head_bytes];
+    is.read(head, stream_head_bytes);
+    if (! is.good() || std::memcmp(head, magic, 4) != 0) {
+        amrex::Error("VisMFCompress::Decompress: not a compressed stream");
+    }
+    const auto total      = static_cast<Long>(get_u64(head+4));
+    const auto chunk_size = static_cast<Long>(get_u64(head+12));
+    const auto nchunks    = static_cast<Long>(get_u64(head+20));
+    if (start < 0 || n < 0 || start+n > total || chunk_size < 1 ||
+        nchunks != (total + chunk_size - 1) / chunk_size)
+    {
+        amrex::Error("VisMFCompress::Decompress: bad stream header");
+    }
+    if (n == 0) { return; }
+
+    Vector<char> table(8*nchunks);
+    is.read(table.data(), static_cast<std::streamsize>(table.size()));
+    Vector<Long> cbytes(nchunks), coffset(nchunks+1, 0);
+    for (Long c = 0; c < nchunks; ++c) {
+        cbytes[c] = static_cast<Long>(get_u64(table.data() + 8*c));
+        coffset[c+1] = coffset[c] + cbytes[c];
+    }
+
+    const Long c0 = start / chunk_size;
+    const Long c1 = (start+n-1) / chunk_size;
+    is.seekg(coffset[c0], std::ios::cur);
+    Vector<char> buf(coffset[c1+1] - coffset[c0]);
+    is.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+    if (! is.good()) {
+        amrex::Error("VisMFCompress::Decompress: read failed");
+    }
+
+    const bool native = (rd == FPC::NativeRealDescriptor());
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for schedule(dynamic) if (c1 > c0)
+#endif
+    for (Long c = c0; c <= c1; ++c) {
+        const Long cbeg = c*chunk_size;
+        const Long cn = std::min(chunk_size, total-cbeg);
+        const Long lo = std::max(start, cbeg);
+        const Long hi = std::min(start+n, cbeg+cn);
+        char const* p = buf.data() + (coffset[c] - coffset[c0]);
+        if (lo == cbeg && hi == cbeg+cn) {
+            decompress_chunk(out + (cbeg-start), cn, p, cbytes[c], rd, native);
+        } else {
+            Vector<Real> tmp(cn);
+            decompress_chunk(tmp.data(), cn, p, cbytes[c], rd, native);
+            std::copy(tmp.begin() + (lo-cbeg), tmp.begin() + (hi-cbeg), out + (lo-start));
+        }
+    }
+}
+
+}
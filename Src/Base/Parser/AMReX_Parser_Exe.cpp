@@ -1,5 +1,7 @@
 #include <AMReX_Parser_Exe.H>
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 namespace amrex {
 
@@ -562,6 +564,338 @@ parser_compile_exe_size (struct parser_node* node, char*& p, std::size_t& exe_si
     }
 }
 
+void
+parser_exe_eval_batch (const char* p, int nvars, Long n, double* AMREX_RESTRICT result,
+                       double const* const* var)
+{
+    if (p == nullptr) {
+        std::fill(result, result+n, std::numeric_limits<double>::max());
+        return;
+    }
+
+    constexpr int nlanes = 64;
+    double s[AMREX_PARSER_STACK_SIZE][nlanes];
+    std::vector<double> x(std::max(nvars,1));
+
+    for (Long ib = 0; ib < n; ib += nlanes) {
+        const int nb = static_cast<int>(std::min(Long(nlanes), n-ib));
+        int sp = 0;
+
+        auto data = [&] (int i) -> double const*
+        {
+            return (i < AMREX_PARSER_LOCAL_IDX0) ? var[i]+ib : s[i-AMREX_PARSER_LOCAL_IDX0];
+        };
+
+        auto push = [&] (auto const& f)
+        {
+            double* AMREX_RESTRICT a = s[sp++];
+            AMREX_PRAGMA_SIMD
+            for (int j = 0; j < nb; ++j) { a[j] = f(j); }
+        };
+
+        auto unary = [&] (auto const& f)
+        {
+            double* AMREX_RESTRICT a = s[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int j = 0; j < nb; ++j) { a[j] = f(a[j]); }
+        };
+
+        auto binary = [&] (auto const& f)
+        {
+            double* AMREX_RESTRICT a = s[sp-2];
+            double const* AMREX_RESTRICT b = s[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int j = 0; j < nb; ++j) { a[j] = f(a[j], b[j]); }
+            --sp;
+        };
+
+        bool diverged = false;
+        const char* q = p;
+        while (*((parser_exe_t*)q) != PARSER_EXE_NULL && !diverged) { // NOLINT
+            switch (*((parser_exe_t*)q))
+            {
+            case PARSER_EXE_NUMBER:
+            {
+                double v = ((ParserExeNumber*)q)->v;
+                push([=] (int) { return v; });
+                q += sizeof(ParserExeNumber);
+                break;
+            }
+            case PARSER_EXE_SYMBOL:
+            {
+                double const* AMREX_RESTRICT d = data(((ParserExeSymbol*)q)->i);
+                push([=] (int j) { return d[j]; });
+                q += sizeof(ParserExeSymbol);
+                break;
+            }
+            case PARSER_EXE_ADD:
+                binary([] (double a, double b) { return a + b; });
+                q += sizeof(ParserExeADD);
+                break;
+            case PARSER_EXE_SUB_F:
+                binary([] (double a, double b) { return a - b; });
+                q += sizeof(ParserExeSUB_F);
+                break;
+            case PARSER_EXE_SUB_B:
+                binary([] (double a, double b) { return b - a; });
+                q += sizeof(ParserExeSUB_B);
+                break;
+            case PARSER_EXE_MUL:
+                binary([] (double a, double b) { return a * b; });
+                q += sizeof(ParserExeMUL);
+                break;
+            case PARSER_EXE_DIV_F:
+                binary([] (double a, double b) { return a / b; });
+                q += sizeof(ParserExeDIV_F);
+                break;
+            case PARSER_EXE_DIV_B:
+                binary([] (double a, double b) { return b / a; });
+                q += sizeof(ParserExeDIV_B);
+                break;
+            case PARSER_EXE_F1:
+            {
+                auto ftype = ((ParserExeF1*)q)->ftype;
+                switch (ftype) {
+                case PARSER_SQRT:
+                    unary([] (double a) { return std::sqrt(a); });
+                    break;
+                case PARSER_ABS:
+                    unary([] (double a) { return std::abs(a); });
+                    break;
+                case PARSER_FLOOR:
+                    unary([] (double a) { return std::floor(a); });
+                    break;
+                case PARSER_CEIL:
+                    unary([] (double a) { return std::ceil(a); });
+                    break;
+                default:
+                    unary([=] (double a) { return parser_call_f1(ftype, a); });
+                }
+                q += sizeof(ParserExeF1);
+                break;
+            }
+            case PARSER_EXE_F2_F:
+            {
+                auto ftype = ((ParserExeF2_F*)q)->ftype;
+                binary([=] (double a, double b) { return parser_call_f2(ftype, a, b); });
+                q += sizeof(ParserExeF2_F);
+                break;
+            }
+            case PARSER_EXE_F2_B:
+            {
+                auto ftype = ((ParserExeF2_B*)q)->ftype;
+                binary([=] (double a, double b) { return parser_call_f2(ftype, b, a); });
+                q += sizeof(ParserExeF2_B);
+                break;
+            }
+            case PARSER_EXE_ADD_VP:
+            {
+                double v = ((ParserExeADD_VP*)q)->v;
+                double const* AMREX_RESTRICT d = data(((ParserExeADD_VP*)q)->i);
+                push([=] (int j) { return v + d[j]; });
+                q += sizeof(ParserExeADD_VP);
+                break;
+            }
+            case PARSER_EXE_SUB_VP:
+            {
+                double v = ((ParserExeSUB_VP*)q)->v;
+                double const* AMREX_RESTRICT d = data(((ParserExeSUB_VP*)q)->i);
+                push([=] (int j) { return v - d[j]; });
+                q += sizeof(ParserExeSUB_VP);
+                break;
+            }
+            case PARSER_EXE_MUL_VP:
+            {
+                double v = ((ParserExeMUL_VP*)q)->v;
+                double const* AMREX_RESTRICT d = data(((ParserExeMUL_VP*)q)->i);
+                push([=] (int j) { return v * d[j]; });
+                q += sizeof(ParserExeMUL_VP);
+                break;
+            }
+            case PARSER_EXE_DIV_VP:
+            {
+                double v = ((ParserExeDIV_VP*)q)->v;
+                double const* AMREX_RESTRICT d = data(((ParserExeDIV_VP*)q)->i);
+                push([=] (int j) { return v / d[j]; });
+                q += sizeof(ParserExeDIV_VP);
+                break;
+            }
+            case PARSER_EXE_ADD_PP:
+            {
+                double const* AMREX_RESTRICT d1 = data(((ParserExeADD_PP*)q)->i1);
+                double const* AMREX_RESTRICT d2 = data(((ParserExeADD_PP*)q)->i2);
+                push([=] (int j) { return d1[j] + d2[j]; });
+                q += sizeof(ParserExeADD_PP);
+                break;
+            }
+            case PARSER_EXE_SUB_PP:
+            {
+                double const* AMREX_RESTRICT d1 = data(((ParserExeSUB_PP*)q)->i1);
+                double const* AMREX_RESTRICT d2 = data(((ParserExeSUB_PP*)q)->i2);
+                push([=] (int j) { return d1[j] - d2[j]; });
+                q += sizeof(ParserExeSUB_PP);
+                break;
+            }
+            case PARSER_EXE_MUL_PP:
+            {
+                double const* AMREX_RESTRICT d1 = data(((ParserExeMUL_PP*)q)->i1);
+                double const* AMREX_RESTRICT d2 = data(((ParserExeMUL_PP*)q)->i2);
+                push([=] (int j) { return d1[j] * d2[j]; });
+                q += sizeof(ParserExeMUL_PP);
+                break;
+            }
+            case PARSER_EXE_DIV_PP:
+            {
+                double const* AMREX_RESTRICT d1 = data(((ParserExeDIV_PP*)q)->i1);
+                double const* AMREX_RESTRICT d2 = data(((ParserExeDIV_PP*)q)->i2);
+                push([=] (int j) { return d1[j] / d2[j]; });
+                q += sizeof(ParserExeDIV_PP);
+                break;
+            }
+            case PARSER_EXE_ADD_VN:
+            {
+                double v = ((ParserExeADD_VN*)q)->v;
+                unary([=] (double a) { return a + v; });
+                q += sizeof(ParserExeADD_VN);
+                break;
+            }
+            case PARSER_EXE_SUB_VN:
+            {
+                double v = ((ParserExeSUB_VN*)q)->v;
+                unary([=] (double a) { return v - a; });
+                q += sizeof(ParserExeSUB_VN);
+                break;
+            }
+            case PARSER_EXE_MUL_VN:
+            {
+                double v = ((ParserExeMUL_VN*)q)->v;
+                unary([=] (double a) { return a * v; });
+                q += sizeof(ParserExeMUL_VN);
+                break;
+            }
+            case PARSER_EXE_DIV_VN:
+            {
+                double v = ((ParserExeDIV_VN*)q)->v;
+                unary([=] (double a) { return v / a; });
+                q += sizeof(ParserExeDIV_VN);
+                break;
+            }
+            case PARSER_EXE_ADD_PN:
+            {
+                double const* AMREX_RESTRICT d = data(((ParserExeADD_PN*)q)->i);
+                double* AMREX_RESTRICT a = s[sp-1];
+                AMREX_PRAGMA_SIMD
+                for (int j = 0; j < nb; ++j) { a[j] += d[j]; }
+                q += sizeof(ParserExeADD_PN);
+                break;
+            }
+            case PARSER_EXE_SUB_PN:
+            {
+                double const* AMREX_RESTRICT d = data(((ParserExeSUB_PN*)q)->i);
+                double sign = ((ParserExeSUB_PN*)q)->sign;
+                double* AMREX_RESTRICT a = s[sp-1];
+                AMREX_PRAGMA_SIMD
+                for (int j = 0; j < nb; ++j) { a[j] = (d[j] - a[j]) * sign; }
+                q += sizeof(ParserExeSUB_PN);
+                break;
+            }
+            case PARSER_EXE_MUL_PN:
+            {
+                double const* AMREX_RESTRICT d = data(((ParserExeMUL_PN*)q)->i);
+                double* AMREX_RESTRICT a = s[sp-1];
+                AMREX_PRAGMA_SIMD
+                for (int j = 0; j < nb; ++j) { a[j] *= d[j]; }
+                q += sizeof(ParserExeMUL_PN);
+                break;
+            }
+            case PARSER_EXE_DIV_PN:
+            {
+                double const* AMREX_RESTRICT d = data(((ParserExeDIV_PN*)q)->i);
+                double* AMREX_RESTRICT a = s[sp-1];
+                if (((ParserExeDIV_PN*)q)->reverse) {
+                    AMREX_PRAGMA_SIMD
+                    for (int j = 0; j < nb; ++j) { a[j] /= d[j]; }
+                } else {
+                    AMREX_PRAGMA_SIMD
+                    for (int j = 0; j < nb; ++j) { a[j] = d[j] / a[j]; }
+                }
+                q += sizeof(ParserExeDIV_PN);
+                break;
+            }
+            case PARSER_EXE_SQUARE:
+                unary([] (double a) { return a*a; });
+                q += sizeof(ParserExeSquare);
+                break;
+            case PARSER_EXE_POWI:
+            {
+                int m = ((ParserExePOWI*)q)->i;
+                unary([=] (double d)
+                {
+                    int k = m;
+                    if (k == 0) { return 1.0; }
+                    if (k < 0) {
+                        d = 1.0/d;
+                        k = -k;
+                    }
+                    double y = 1.0;
+                    while (k > 1) {
+                        if (k % 2 == 0) {
+                            d *= d;
+                            k = k/2;
+                        } else {
+                            y *= d;
+                            d *= d;
+                            k = (k-1)/2;
+                        }
+                    }
+                    return d*y;
+                });
+                q += sizeof(ParserExePOWI);
+                break;
+            }
+            case PARSER_EXE_IF:
+            {
+                // Only uniform branches are taken in batch.  A chunk that
+                // diverges is evaluated point by point.
+                double const* cond = s[--sp];
+                int ntrue = 0;
+                for (int j = 0; j < nb; ++j) {
+                    ntrue += (cond[j] != 0.0) ? 1 : 0;
+                }
+                if (ntrue == 0) { // false branch
+                    q += ((ParserExeIF*)q)->offset;
+                } else if (ntrue != nb) {
+                    diverged = true;
+                }
+                q += sizeof(ParserExeIF);
+                break;
+            }
+            case PARSER_EXE_JUMP:
+            {
+                int offset = ((ParserExeJUMP*)q)->offset;
+                q += sizeof(ParserExeJUMP) + offset;
+                break;
+            }
+            default:
+                AMREX_ALWAYS_ASSERT_WITH_MESSAGE(false,"parser_exe_eval_batch: unknown node type");
+            }
+        }
+
+        if (diverged) {
+            for (int j = 0; j < nb; ++j) {
+                for (int i = 0; i < nvars; ++i) {
+                    x[i] = var[i][ib+j];
+                }
+                result[ib+j] = parser_exe_eval(p, x.data());
+            }
+        } else {
+            double const* AMREX_RESTRICT a = s[sp-1];
+            AMREX_PRAGMA_SIMD
+            for (int j = 0; j < nb; ++j) { result[ib+j] = a[j]; }
+        }
+    }
+}
+
 namespace {
     enum paren_t {
         paren_plusminus,
@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <cstdarg>
 #include <string>
+#include <utility>
+#include <vector>
 
 void
 amrex_parsererror (char const *s, ...)
@@ -1668,4 +1670,234 @@ void parser_set_number (struct parser_node* node, double v)
     node->type = PARSER_NUMBER;
 }
 
+
+namespace {
+
+    // Rough cost of evaluating a node.  Function calls are weighted more
+    // than arithmetic operations.
+    int parser_cse_cost (struct parser_node* node)
+    {
+        switch (node->type)
+        {
+        case PARSER_NUMBER:
+        case PARSER_SYMBOL:
+            return 0;
+        case PARSER_ADD:
+        case PARSER_SUB:
+        case PARSER_MUL:
+        case PARSER_DIV:
+            return 1 + parser_cse_cost(node->l) + parser_cse_cost(node->r);
+        case PARSER_F1:
+            return 4 + parser_cse_cost(((struct parser_f1*)node)->l);
+        case PARSER_F2:
+            return 4 + parser_cse_cost(((struct parser_f2*)node)->l)
+                +      parser_cse_cost(((struct parser_f2*)node)->r);
+        case PARSER_F3:
+            return 1 + parser_cse_cost(((struct parser_f3*)node)->n1)
+                +      std::max(parser_cse_cost(((struct parser_f3*)node)->n2),
+                                parser_cse_cost(((struct parser_f3*)node)->n3));
+        default:
+            return 0;
+        }
+    }
+
+    // Collect the nodes of an expression that are always evaluated.  The
+    // branches of if are skipped, because hoisting them out would evaluate
+    // them unconditionally.
+    void parser_cse_collect (struct parser_node* node, std::vector<struct parser_node*>& nodes)
+    {
+        switch (node->type)
+        {
+        case PARSER_ADD:
+        case PARSER_SUB:
+        case PARSER_MUL:
+        case PARSER_DIV:
+            nodes.push_back(node);
+            parser_cse_collect(node->l, nodes);
+            parser_cse_collect(node->r, nodes);
+            break;
+        case PARSER_F1:
+            nodes.push_back(node);
+            parser_cse_collect(((struct parser_f1*)node)->l, nodes);
+            break;
+        case PARSER_F2:
+            nodes.push_back(node);
+            parser_cse_collect(((struct parser_f2*)node)->l, nodes);
+            parser_cse_collect(((struct parser_f2*)node)->r, nodes);
+            break;
+        case PARSER_F3:
+            nodes.push_back(node);
+            parser_cse_collect(((struct parser_f3*)node)->n1, nodes);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void parser_cse_cover (struct parser_node* node, std::set<struct parser_node*>& covered)
+    {
+        switch (node->type)
+        {
+        case PARSER_ADD:
+        case PARSER_SUB:
+        case PARSER_MUL:
+        case PARSER_DIV:
+            covered.insert(node->l);
+            covered.insert(node->r);
+            parser_cse_cover(node->l, covered);
+            parser_cse_cover(node->r, covered);
+            break;
+        case PARSER_F1:
+            covered.insert(((struct parser_f1*)node)->l);
+            parser_cse_cover(((struct parser_f1*)node)->l, covered);
+            break;
+        case PARSER_F2:
+            covered.insert(((struct parser_f2*)node)->l);
+            covered.insert(((struct parser_f2*)node)->r);
+            parser_cse_cover(((struct parser_f2*)node)->l, covered);
+            parser_cse_cover(((struct parser_f2*)node)->r, covered);
+            break;
+        case PARSER_F3:
+            covered.insert(((struct parser_f3*)node)->n1);
+            parser_cse_cover(((struct parser_f3*)node)->n1, covered);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Find the final expression, i.e., the value of the whole program.
+    struct parser_node** parser_cse_final_expr (struct parser_node** pnode)
+    {
+        while ((*pnode)->type == PARSER_LIST) {
+            pnode = &((*pnode)->r);
+        }
+        return pnode;
+    }
+
+    // Group the repeated subexpressions of the final expression.  Larger
+    // subexpressions are picked first, and their descendants are not
+    // considered anymore.
+    std::vector<std::vector<struct parser_node*>>
+    parser_cse_analyze (struct parser_node* expr)
+    {
+        std::vector<std::vector<struct parser_node*>> r;
+        if (expr->type == PARSER_ASSIGN) { return r; }
+
+        std::vector<struct parser_node*> nodes;
+        parser_cse_collect(expr, nodes);
+
+        constexpr int min_cost = 2;
+        std::vector<std::pair<int,struct parser_node*>> candidates;
+        for (auto* node : nodes) {
+            int cost = parser_cse_cost(node);
+            if (cost >= min_cost) {
+                candidates.emplace_back(cost, node);
+            }
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [] (auto const& a, auto const& b) { return a.first > b.first; });
+
+        std::set<struct parser_node*> covered;
+        auto const n = candidates.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            auto* node = candidates[i].second;
+            if (covered.count(node)) { continue; }
+            std::vector<struct parser_node*> occurrences{node};
+            for (std::size_t j = i+1; j < n && candidates[j].first == candidates[i].first; ++j) {
+                auto* other = candidates[j].second;
+                if (!covered.count(other) && parser_node_equal(node, other)) {
+                    occurrences.push_back(other);
+                }
+            }
+            if (occurrences.size() > 1) {
+                for (auto* occ : occurrences) {
+                    covered.insert(occ);
+                    parser_cse_cover(occ, covered);
+                }
+                r.push_back(std::move(occurrences));
+            }
+        }
+        return r;
+    }
+
+    std::string parser_cse_name (std::size_t i)
+    {
+        // '#' cannot appear in a user symbol.
+        return std::string("cse#") + std::to_string(i);
+    }
+}
+
+struct amrex_parser*
+parser_cse (struct amrex_parser* parser)
+{
+    auto cse = parser_cse_analyze(*parser_cse_final_expr(&(parser->ast)));
+    if (cse.empty()) { return nullptr; }
+
+    const std::size_t node_size = parser_aligned_size(sizeof(struct parser_node));
+    std::size_t extra_size = 0;
+    for (std::size_t i = 0; i < cse.size(); ++i) {
+        const std::size_t name_size = parser_aligned_size(parser_cse_name(i).size()+1);
+        // definition, assign, symbol and list
+        extra_size += parser_ast_size(cse[i][0]) + 3*node_size + name_size;
+        // each occurrence becomes a symbol
+        extra_size += cse[i].size() * name_size;
+    }
+
+    auto *dest = (struct amrex_parser*) std::malloc(sizeof(struct amrex_parser));
+    dest->sz_mempool = parser_ast_size(parser->ast) + extra_size;
+    dest->p_root = std::malloc(dest->sz_mempool);
+    dest->p_free = dest->p_root;
+    dest->ast = parser_ast_dup(dest, parser->ast, 0);
+
+    // Redo the analysis on the copy so that we can modify it in place.
+    auto** pexpr = parser_cse_final_expr(&(dest->ast));
+    cse = parser_cse_analyze(*pexpr);
+
+    // Copy the definitions first, because the occurrences are about to be
+    // overwritten.
+    std::vector<struct parser_node*> defs;
+    defs.reserve(cse.size());
+    for (auto const& occurrences : cse) {
+        defs.push_back(parser_ast_dup(dest, occurrences[0], 0));
+    }
+
+    auto make_symbol = [&] (struct parser_node* node, std::string const& name)
+    {
+        auto* sym = (struct parser_symbol*)node;
+        sym->type = PARSER_SYMBOL;
+        sym->name = (char*) parser_allocate(dest, name.size()+1);
+        std::strncpy(sym->name, name.c_str(), name.size()+1);
+        sym->ip = -1;
+        return sym;
+    };
+
+    for (std::size_t i = 0; i < cse.size(); ++i) {
+        for (auto* occ : cse[i]) {
+            make_symbol(occ, parser_cse_name(i));
+        }
+    }
+
+    struct parser_node* expr = *pexpr;
+    for (auto i = static_cast<int>(cse.size())-1; i >= 0; --i) {
+        auto* asgn = (struct parser_assign*) parser_allocate(dest, sizeof(struct parser_node));
+        asgn->type = PARSER_ASSIGN;
+        asgn->s = make_symbol((struct parser_node*)parser_allocate(dest, sizeof(struct parser_node)),
+                              parser_cse_name(i));
+        asgn->v = defs[i];
+        auto* list = (struct parser_node*) parser_allocate(dest, sizeof(struct parser_node));
+        list->type = PARSER_LIST;
+        list->l = (struct parser_node*)asgn;
+        list->r = expr;
+        expr = list;
+    }
+    *pexpr = expr;
+
+    if ((char*)dest->p_root + dest->sz_mempool < (char*)dest->p_free) {
+        amrex::Abort("parser_cse: error in memory size");
+    }
+
+    return dest;
+}
+
 }
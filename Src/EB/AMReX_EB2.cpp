@@ -216,6 +216,8 @@ Build (const Geometry& geom, int required_coarsening_level,
         pp.queryAdd("stl_center", stl_center);
         int stl_reverse_normal = 0;
         pp.queryAdd("stl_reverse_normal", stl_reverse_normal);
+        bool stl_use_bvh = true;
+        pp.queryAdd("stl_use_bvh", stl_use_bvh);
         IndexSpace::push(new IndexSpaceSTL(stl_file, stl_scale, // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
                                            {stl_center[0], stl_center[1], stl_center[2]},
                                            stl_reverse_normal,
@@ -223,7 +225,7 @@ Build (const Geometry& geom, int required_coarsening_level,
                                            max_coarsening_level, ngrow,
                                            build_coarse_level_by_coarsening,
                                            a_extend_domain_face,
-                                           a_num_coarsen_opt));
+                                           a_num_coarsen_opt, stl_use_bvh));
     }
     else
     {
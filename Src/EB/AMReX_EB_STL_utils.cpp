@@ -1,6 +1,7 @@
 #include <AMReX_EB_STL_utils.H>
 #include <AMReX_EB_triGeomOps_K.H>
 #include <AMReX_IntConv.H>
+#include <algorithm>
 #include <cstring>
 
 namespace amrex
@@ -89,6 +90,131 @@ namespace {
             return std::make_pair(false,0.0_rt);
         }
     }
+
+    // Does the bounding box of the node overlap with box [lo,hi]?
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    bool bvh_overlaps (STLtools::BVHNode const& node, XDim3 const& lo, XDim3 const& hi)
+    {
+        return !(hi.x < node.lo.x || lo.x > node.hi.x ||
+                 hi.y < node.lo.y || lo.y > node.hi.y ||
+                 hi.z < node.lo.z || lo.z > node.hi.z);
+    }
+
+    // Depth-first traversal of the BVH.  Subtrees are skipped if
+    // node_test returns false, and tri_op is called for every triangle
+    // in the leaves that are visited.
+    template <typename NT, typename TO>
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void bvh_for_each (STLtools::BVHNode const* nodes, NT const& node_test, TO const& tri_op)
+    {
+        int stack[STLtools::bvh_max_stack_size];
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0) {
+            STLtools::BVHNode const& node = nodes[stack[--sp]];
+            if (node_test(node)) {
+                if (node.left < 0) {
+                    for (int it = node.tri_begin; it < node.tri_end; ++it) {
+                        tri_op(it);
+                    }
+                } else {
+                    stack[sp++] = node.right;
+                    stack[sp++] = node.left;
+                }
+            }
+        }
+    }
+
+    // Number of triangles intersected by line ab
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    int num_line_tri_intersects (Real a[3], Real b[3], STLtools::BVHNode const* nodes,
+                                 STLtools::Triangle const* tri_pts)
+    {
+        XDim3 lo{amrex::min(a[0],b[0]), amrex::min(a[1],b[1]), amrex::min(a[2],b[2])};
+        XDim3 hi{amrex::max(a[0],b[0]), amrex::max(a[1],b[1]), amrex::max(a[2],b[2])};
+        int num_intersects = 0;
+        bvh_for_each(nodes,
+                     [&] (STLtools::BVHNode const& node) { return bvh_overlaps(node, lo, hi); },
+                     [&] (int it)
+                     {
+                         if (line_tri_intersects(a, b, tri_pts[it])) {
+                             ++num_intersects;
+                         }
+                     });
+        return num_intersects;
+    }
+
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    bool tri_box_overlaps (STLtools::Triangle const& tri, XDim3 const& c, XDim3 const& h)
+    {
+        const Real t1[] = {tri.v1.x, tri.v1.y, tri.v1.z};
+        const Real t2[] = {tri.v2.x, tri.v2.y, tri.v2.z};
+        const Real t3[] = {tri.v3.x, tri.v3.y, tri.v3.z};
+        const Real cc[] = {c.x, c.y, c.z};
+        const Real hh[] = {h.x, h.y, h.z};
+        return tri_geom_ops::tri_box_overlaps(t1, t2, t3, cc, hh);
+    }
+
+    // Build the subtree for triangles [begin,end) of ids and return the
+    // index of its root node.  The triangles are split at the median of
+    // their centroids along the longest axis of the centroid bounding box.
+    int bvh_build_node (Vector<STLtools::BVHNode>& nodes, Vector<int>& ids,
+                        Vector<XDim3> const& cent, Gpu::PinnedVector<STLtools::Triangle> const& tri,
+                        int begin, int end, int max_leaf_size, int depth)
+    {
+        AMREX_ALWAYS_ASSERT(depth < STLtools::bvh_max_stack_size-1);
+
+        STLtools::BVHNode node;
+        constexpr Real hugeval = std::numeric_limits<Real>::max();
+        node.lo = XDim3{ hugeval,  hugeval,  hugeval};
+        node.hi = XDim3{-hugeval, -hugeval, -hugeval};
+        node.min_tri_id = std::numeric_limits<int>::max();
+        XDim3 clo = node.lo;
+        XDim3 chi = node.hi;
+        for (int i = begin; i < end; ++i) {
+            auto const& t = tri[ids[i]];
+            node.lo.x = amrex::min(node.lo.x, t.v1.x, t.v2.x, t.v3.x);
+            node.lo.y = amrex::min(node.lo.y, t.v1.y, t.v2.y, t.v3.y);
+            node.lo.z = amrex::min(node.lo.z, t.v1.z, t.v2.z, t.v3.z);
+            node.hi.x = amrex::max(node.hi.x, t.v1.x, t.v2.x, t.v3.x);
+            node.hi.y = amrex::max(node.hi.y, t.v1.y, t.v2.y, t.v3.y);
+            node.hi.z = amrex::max(node.hi.z, t.v1.z, t.v2.z, t.v3.z);
+            auto const& c = cent[ids[i]];
+            clo.x = amrex::min(clo.x, c.x);
+            clo.y = amrex::min(clo.y, c.y);
+            clo.z = amrex::min(clo.z, c.z);
+            chi.x = amrex::max(chi.x, c.x);
+            chi.y = amrex::max(chi.y, c.y);
+            chi.z = amrex::max(chi.z, c.z);
+            node.min_tri_id = std::min(node.min_tri_id, ids[i]);
+        }
+
+        int inode = static_cast<int>(nodes.size());
+        nodes.push_back(node);
+
+        if (end - begin <= max_leaf_size) {
+            nodes[inode].tri_begin = begin;
+            nodes[inode].tri_end = end;
+        } else {
+            Real lx = chi.x - clo.x;
+            Real ly = chi.y - clo.y;
+            Real lz = chi.z - clo.z;
+            int dir = (lx >= ly && lx >= lz) ? 0 : ((ly >= lz) ? 1 : 2);
+            int mid = begin + (end-begin)/2;
+            std::nth_element(ids.begin()+begin, ids.begin()+mid, ids.begin()+end,
+                             [&] (int a, int b) {
+                                 Real ca = (dir == 0) ? cent[a].x : ((dir == 1) ? cent[a].y : cent[a].z);
+                                 Real cb = (dir == 0) ? cent[b].x : ((dir == 1) ? cent[b].y : cent[b].z);
+                                 return (ca < cb) || (ca == cb && a < b);
+                             });
+            int left  = bvh_build_node(nodes, ids, cent, tri, begin, mid, max_leaf_size, depth+1);
+            int right = bvh_build_node(nodes, ids, cent, tri, mid  , end, max_leaf_size, depth+1);
+            nodes[inode].left = left;
+            nodes[inode].right = right;
+        }
+
+        return inode;
+    }
 }
 
 void
@@ -245,12 +371,10 @@ STLtools::prepare ()
     }
     ParallelDescriptor::Bcast((char*)(m_tri_pts_h.dataPtr()), m_num_tri*sizeof(Triangle));
 
-    //device vectors
-    m_tri_pts_d.resize(m_num_tri);
-    m_tri_normals_d.resize(m_num_tri);
+    // This also copies the sorted triangles to the device
+    build_bvh();
 
-    Gpu::copyAsync(Gpu::hostToDevice, m_tri_pts_h.begin(), m_tri_pts_h.end(),
-                   m_tri_pts_d.begin());
+    m_tri_normals_d.resize(m_num_tri);
 
     Triangle const* tri_pts = m_tri_pts_d.data();
     XDim3* tri_norm = m_tri_normals_d.data();
@@ -401,9 +525,10 @@ STLtools::prepare ()
     // We now need to figure out if the boundary and the reference is
     // outside or inside the object.
     XDim3 ptref = m_ptref;
+    int const* tri_id = m_tri_id_d.data();
     int num_isects = Reduce::Sum<int>(m_num_tri, [=] AMREX_GPU_DEVICE (int i) -> int
         {
-            if (i == 0) {
+            if (tri_id[i] == 0) {
                 return 1-is_ref_positive;
             } else {
                 Real p1[] = {ptref.x, ptref.y, ptref.z};
@@ -415,16 +540,58 @@ STLtools::prepare ()
     m_boundry_is_outside = num_isects % 2 == 0;
 }
 
+void
+STLtools::build_bvh ()
+{
+    BL_PROFILE("STLtools::build_bvh");
+
+    Vector<int> ids(m_num_tri);
+    Vector<XDim3> cent(m_num_tri);
+    for (int i = 0; i < m_num_tri; ++i) {
+        ids[i] = i;
+        Triangle const& tri = m_tri_pts_h[i];
+        cent[i] = XDim3{(tri.v1.x + tri.v2.x + tri.v3.x) / 3._rt,
+                        (tri.v1.y + tri.v2.y + tri.v3.y) / 3._rt,
+                        (tri.v1.z + tri.v2.z + tri.v3.z) / 3._rt};
+    }
+
+    // Without the optimization, the tree has a single leaf containing all
+    // the triangles in their original order.
+    int max_leaf_size = m_bvh_optimization ? bvh_max_leaf_size : std::max(m_num_tri,1);
+
+    Vector<BVHNode> nodes;
+    nodes.reserve(2*(m_num_tri/bvh_max_leaf_size+1));
+    bvh_build_node(nodes, ids, cent, m_tri_pts_h, 0, m_num_tri, max_leaf_size, 0);
+
+    if (amrex::Verbose() > 0) {
+        amrex::Print() << "    Number of BVH nodes: " << nodes.size() << '\n';
+    }
+
+    Gpu::PinnedVector<Triangle> tri_sorted(m_num_tri);
+    for (int i = 0; i < m_num_tri; ++i) {
+        tri_sorted[i] = m_tri_pts_h[ids[i]];
+    }
+
+    m_tri_pts_d.resize(m_num_tri);
+    m_tri_id_d.resize(m_num_tri);
+    m_bvh_nodes_d.resize(nodes.size());
+
+    Gpu::copyAsync(Gpu::hostToDevice, tri_sorted.begin(), tri_sorted.end(),
+                   m_tri_pts_d.begin());
+    Gpu::copyAsync(Gpu::hostToDevice, ids.begin(), ids.end(), m_tri_id_d.begin());
+    Gpu::copyAsync(Gpu::hostToDevice, nodes.begin(), nodes.end(), m_bvh_nodes_d.begin());
+    Gpu::streamSynchronize();
+}
+
 void
 STLtools::fill (MultiFab& mf, IntVect const& nghost, Geometry const& geom,
                 Real outside_value, Real inside_value) const
 {
-    int num_triangles = m_num_tri;
-
     const auto plo = geom.ProbLoArray();
     const auto dx  = geom.CellSizeArray();
 
     const Triangle* tri_pts = m_tri_pts_d.data();
+    const BVHNode* bvh_nodes = m_bvh_nodes_d.data();
     XDim3 ptmin = m_ptmin;
     XDim3 ptmax = m_ptmax;
     XDim3 ptref = m_ptref;
@@ -449,11 +616,7 @@ STLtools::fill (MultiFab& mf, IntVect const& nghost, Geometry const& geom,
             coords[2] >= ptmin.z && coords[2] <= ptmax.z)
         {
             Real pr[]={ptref.x, ptref.y, ptref.z};
-            for (int tr=0; tr < num_triangles; ++tr) {
-                if (line_tri_intersects(pr, coords, tri_pts[tr])) {
-                    ++num_intersects;
-                }
-            }
+            num_intersects = num_line_tri_intersects(pr, coords, bvh_nodes, tri_pts);
         }
         ma[box_no](i,j,k) = (num_intersects % 2 == 0) ? reference_value : other_value;
     });
@@ -489,10 +652,67 @@ STLtools::getBoxType (Box const& box, Geometry const& geom, RunOn) const
     {
         return m_boundry_is_outside ? allregular : allcovered;
     }
+    else if (m_bvh_optimization)
+    {
+        // Instead of sampling the object at every node of the box, we ask
+        // the tree if any triangle intersects the box.  If none does, the
+        // whole box is on one side of the surface, and a few points
+        // suffice to tell which side.
+        const Triangle* tri_pts = m_tri_pts_d.data();
+        const BVHNode* bvh_nodes = m_bvh_nodes_d.data();
+        XDim3 ptmin = m_ptmin;
+        XDim3 ptmax = m_ptmax;
+        XDim3 ptref = m_ptref;
+        int ref_value = m_boundry_is_outside ? 1 : 0;
+
+        // Slightly enlarged so that a triangle touching the box counts
+        Real eps = Real(1.e-3) * std::max({AMREX_D_DECL(dx[0],dx[1],dx[2])});
+        XDim3 lo{blo.x-eps, blo.y-eps, blo.z-eps};
+        XDim3 hi{bhi.x+eps, bhi.y+eps, bhi.z+eps};
+        XDim3 c{Real(0.5)*(lo.x+hi.x), Real(0.5)*(lo.y+hi.y), Real(0.5)*(lo.z+hi.z)};
+        XDim3 h{Real(0.5)*(hi.x-lo.x), Real(0.5)*(hi.y-lo.y), Real(0.5)*(hi.z-lo.z)};
+
+        // Returns the box type.  This is a serial search, so it runs on a
+        // single thread.
+        int box_type = Reduce::Sum<int>(1, [=] AMREX_GPU_DEVICE (int) -> int
+        {
+            bool cut = false;
+            bvh_for_each(bvh_nodes,
+                         [&] (BVHNode const& node) { return !cut && bvh_overlaps(node, lo, hi); },
+                         [&] (int it) { cut = cut || tri_box_overlaps(tri_pts[it], c, h); });
+            if (cut) { return mixedcells; }
+
+            // A ray passing through an edge or a vertex of a triangle
+            // could give the wrong parity, so we test the center and two
+            // corners, and treat any disagreement as cut.
+            XDim3 const pts[] = {c, blo, bhi};
+            int nfluid = 0;
+            for (auto const& pt : pts) {
+                int num_intersects = 0;
+                if (pt.x >= ptmin.x && pt.x <= ptmax.x &&
+                    pt.y >= ptmin.y && pt.y <= ptmax.y &&
+                    pt.z >= ptmin.z && pt.z <= ptmax.z)
+                {
+                    Real pr[] = {ptref.x, ptref.y, ptref.z};
+                    Real coords[] = {pt.x, pt.y, pt.z};
+                    num_intersects = num_line_tri_intersects(pr, coords, bvh_nodes, tri_pts);
+                }
+                nfluid += (num_intersects % 2 == 0) ? ref_value : 1-ref_value;
+            }
+            if (nfluid == 0) {
+                return allcovered;
+            } else if (nfluid == 3) {
+                return allregular;
+            } else {
+                return mixedcells;
+            }
+        });
+        return box_type;
+    }
     else
     {
-        int num_triangles = m_num_tri;
         const Triangle* tri_pts = m_tri_pts_d.data();
+        const BVHNode* bvh_nodes = m_bvh_nodes_d.data();
         XDim3 ptmin = m_ptmin;
         XDim3 ptmax = m_ptmax;
         XDim3 ptref = m_ptref;
@@ -519,11 +739,7 @@ STLtools::getBoxType (Box const& box, Geometry const& geom, RunOn) const
                 coords[2] >= ptmin.z && coords[2] <= ptmax.z)
             {
                 Real pr[]={ptref.x, ptref.y, ptref.z};
-                for (int tr=0; tr < num_triangles; ++tr) {
-                    if (line_tri_intersects(pr, coords, tri_pts[tr])) {
-                        ++num_intersects;
-                    }
-                }
+                num_intersects = num_line_tri_intersects(pr, coords, bvh_nodes, tri_pts);
             }
 
             return (num_intersects % 2 == 0) ? ref_value : 1-ref_value;
@@ -544,12 +760,11 @@ STLtools::getBoxType (Box const& box, Geometry const& geom, RunOn) const
 void
 STLtools::fillFab (BaseFab<Real>& levelset, const Geometry& geom, RunOn, Box const&) const
 {
-    int num_triangles = m_num_tri;
-
     const auto plo = geom.ProbLoArray();
     const auto dx  = geom.CellSizeArray();
 
     const Triangle* tri_pts = m_tri_pts_d.data();
+    const BVHNode* bvh_nodes = m_bvh_nodes_d.data();
     XDim3 ptmin = m_ptmin;
     XDim3 ptmax = m_ptmax;
     XDim3 ptref = m_ptref;
@@ -574,11 +789,7 @@ STLtools::fillFab (BaseFab<Real>& levelset, const Geometry& geom, RunOn, Box con
             coords[2] >= ptmin.z && coords[2] <= ptmax.z)
         {
             Real pr[]={ptref.x, ptref.y, ptref.z};
-            for (int tr=0; tr < num_triangles; ++tr) {
-                if (line_tri_intersects(pr, coords, tri_pts[tr])) {
-                    ++num_intersects;
-                }
-            }
+            num_intersects = num_line_tri_intersects(pr, coords, bvh_nodes, tri_pts);
         }
         a(i,j,k) = (num_intersects % 2 == 0) ? reference_value : other_value;
     });
@@ -597,6 +808,8 @@ STLtools::getIntercept (Array<Array4<Real>,AMREX_SPACEDIM> const& inter_arr,
 
     const Triangle* tri_pts = m_tri_pts_d.data();
     const XDim3* tri_norm = m_tri_normals_d.data();
+    const BVHNode* bvh_nodes = m_bvh_nodes_d.data();
+    const int* tri_id = m_tri_id_d.data();
 
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
         Array4<Real> const& inter = inter_arr[idim];
@@ -614,62 +827,76 @@ STLtools::getIntercept (Array<Array4<Real>,AMREX_SPACEDIM> const& inter_arr,
                          plo[2]+static_cast<Real>(k)*dx[2]
 #endif
                 };
+                XDim3 p2 = p1;
+                // If several triangles intersect the edge, the one that
+                // comes first in the STL file wins.
+                int first_tri = num_triangles;
+                auto node_test = [&] (BVHNode const& node)
+                {
+                    return node.min_tri_id < first_tri && bvh_overlaps(node, p1, p2);
+                };
                 if (idim == 0) {
-                    Real x2 = plo[0]+static_cast<Real>(i+1)*dx[0];
-                    int it;
-                    for (it=0; it < num_triangles; ++it) {
-                        auto const& tri = tri_pts[it];
-                        auto tmp = edge_tri_intersects(p1.x, x2, p1.y, p1.z,
-                                                       tri.v1, tri.v2, tri.v3,
-                                                       tri_norm[it],
-                                                       lst(i+1,j,k)-lst(i,j,k));
-                        if (tmp.first) {
-                            r = tmp.second;
-                            break;
+                    p2.x = plo[0]+static_cast<Real>(i+1)*dx[0];
+                    bvh_for_each(bvh_nodes, node_test, [&] (int it)
+                    {
+                        if (tri_id[it] < first_tri) {
+                            auto const& tri = tri_pts[it];
+                            auto tmp = edge_tri_intersects(p1.x, p2.x, p1.y, p1.z,
+                                                           tri.v1, tri.v2, tri.v3,
+                                                           tri_norm[it],
+                                                           lst(i+1,j,k)-lst(i,j,k));
+                            if (tmp.first) {
+                                r = tmp.second;
+                                first_tri = tri_id[it];
+                            }
                         }
-                    }
-                    if (it == num_triangles) {
-                        r = (lst(i,j,k) > 0._rt) ? p1.x : x2;
+                    });
+                    if (first_tri == num_triangles) {
+                        r = (lst(i,j,k) > 0._rt) ? p1.x : p2.x;
                     }
                 } else if (idim == 1) {
-                    Real y2 = plo[1]+static_cast<Real>(j+1)*dx[1];
-                    int it;
-                    for (it=0; it < num_triangles; ++it) {
-                        auto const& tri = tri_pts[it];
-                        auto const& norm = tri_norm[it];
-                        auto tmp = edge_tri_intersects(p1.y, y2, p1.z, p1.x,
-                                                       {tri.v1.y, tri.v1.z, tri.v1.x},
-                                                       {tri.v2.y, tri.v2.z, tri.v2.x},
-                                                       {tri.v3.y, tri.v3.z, tri.v3.x},
-                                                       {  norm.y,   norm.z,   norm.x},
-                                                       lst(i,j+1,k)-lst(i,j,k));
-                        if (tmp.first) {
-                            r = tmp.second;
-                            break;
+                    p2.y = plo[1]+static_cast<Real>(j+1)*dx[1];
+                    bvh_for_each(bvh_nodes, node_test, [&] (int it)
+                    {
+                        if (tri_id[it] < first_tri) {
+                            auto const& tri = tri_pts[it];
+                            auto const& norm = tri_norm[it];
+                            auto tmp = edge_tri_intersects(p1.y, p2.y, p1.z, p1.x,
+                                                           {tri.v1.y, tri.v1.z, tri.v1.x},
+                                                           {tri.v2.y, tri.v2.z, tri.v2.x},
+                                                           {tri.v3.y, tri.v3.z, tri.v3.x},
+                                                           {  norm.y,   norm.z,   norm.x},
+                                                           lst(i,j+1,k)-lst(i,j,k));
+                            if (tmp.first) {
+                                r = tmp.second;
+                                first_tri = tri_id[it];
+                            }
                         }
-                    }
-                    if (it == num_triangles) {
-                        r = (lst(i,j,k) > 0._rt) ? p1.y : y2;
+                    });
+                    if (first_tri == num_triangles) {
+                        r = (lst(i,j,k) > 0._rt) ? p1.y : p2.y;
                     }
                 } else {
-                    Real z2 = plo[2]+static_cast<Real>(k+1)*dx[2];
-                    int it;
-                    for (it=0; it < num_triangles; ++it) {
-                        auto const& tri = tri_pts[it];
-                        auto const& norm = tri_norm[it];
-                        auto tmp = edge_tri_intersects(p1.z, z2, p1.x, p1.y,
-                                                       {tri.v1.z, tri.v1.x, tri.v1.y},
-                                                       {tri.v2.z, tri.v2.x, tri.v2.y},
-                                                       {tri.v3.z, tri.v3.x, tri.v3.y},
-                                                       {  norm.z,   norm.x,   norm.y},
-                                                       lst(i,j,k+1)-lst(i,j,k));
-                        if (tmp.first) {
-                            r = tmp.second;
-                            break;
+                    p2.z = plo[2]+static_cast<Real>(k+1)*dx[2];
+                    bvh_for_each(bvh_nodes, node_test, [&] (int it)
+                    {
+                        if (tri_id[it] < first_tri) {
+                            auto const& tri = tri_pts[it];
+                            auto const& norm = tri_norm[it];
+                            auto tmp = edge_tri_intersects(p1.z, p2.z, p1.x, p1.y,
+                                                           {tri.v1.z, tri.v1.x, tri.v1.y},
+                                                           {tri.v2.z, tri.v2.x, tri.v2.y},
+                                                           {tri.v3.z, tri.v3.x, tri.v3.y},
+                                                           {  norm.z,   norm.x,   norm.y},
+                                                           lst(i,j,k+1)-lst(i,j,k));
+                            if (tmp.first) {
+                                r = tmp.second;
+                                first_tri = tri_id[it];
+                            }
                         }
-                    }
-                    if (it == num_triangles) {
-                        r = (lst(i,j,k) > 0._rt) ? p1.z : z2;
+                    });
+                    if (first_tri == num_triangles) {
+                        r = (lst(i,j,k) > 0._rt) ? p1.z : p2.z;
                     }
                 }
             }
@@ -0,0 +1,75 @@
+#include <AMReX_FFT.H>
+
+#include <cmath>
+#include <limits>
+
+namespace amrex::FFT::detail
+{
+
+BoxArray decompose (Box const& box, int nprocs, IntVect const& chop)
+{
+    const IntVect len = box.length();
+
+    Vector<int> dirs;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (chop[idim]) { dirs.push_back(idim); }
+    }
+
+    // Number of pieces in each direction
+    IntVect np(1);
+    if (dirs.size() == 1) {
+        np[dirs[0]] = std::min(nprocs, len[dirs[0]]);
+    } else if (dirs.size() == 2) {
+        // Use as many processes as possible, with pieces as close to
+        // square as possible.
+        const int d0 = dirs[0];
+        const int d1 = dirs[1];
+        double best_aspect = std::numeric_limits<double>::max();
+        for (int p0 = 1; p0 <= std::min(nprocs, len[d0]); ++p0) {
+            const int p1 = std::min(nprocs/p0, len[d1]);
+            const double aspect = std::abs(std::log((double(len[d0])/p0) /
+                                                    (double(len[d1])/p1)));
+            if (p0*p1 > np[d0]*np[d1] || (p0*p1 == np[d0]*np[d1] && aspect < best_aspect)) {
+                np[d0] = p0;
+                np[d1] = p1;
+                best_aspect = aspect;
+            }
+        }
+    }
+
+    // Split len[idim] cells as evenly as possible
+    auto split = [&] (int idim, int i, int& lo, int& n)
+    {
+        const int q = len[idim] / np[idim];
+        const int r = len[idim] % np[idim];
+        n = q + ((i < r) ? 1 : 0);
+        lo = box.smallEnd(idim) + i*q + std::min(i,r);
+    };
+
+    BoxList bl;
+    const Box pbox(IntVect(0), np-1);
+    for (Long i = 0, N = pbox.numPts(); i < N; ++i) {
+        const IntVect piv = pbox.atOffset(i);
+        Box b = box;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            int lo, n;
+            split(idim, piv[idim], lo, n);
+            b.setRange(idim, lo, n);
+        }
+        bl.push_back(b);
+    }
+    return BoxArray(std::move(bl));
+}
+
+DistributionMapping oneBoxPerProc (BoxArray const& ba)
+{
+    const int nprocs = ParallelContext::NProcsSub();
+    AMREX_ALWAYS_ASSERT(int(ba.size()) <= nprocs);
+    Vector<int> pmap(ba.size());
+    for (int i = 0, N = int(ba.size()); i < N; ++i) {
+        pmap[i] = ParallelContext::local_to_global_rank(i);
+    }
+    return DistributionMapping(std::move(pmap));
+}
+
+}
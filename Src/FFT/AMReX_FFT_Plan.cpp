@@ -0,0 +1,324 @@
+#include <AMReX_FFT_Plan.H>
+#include <AMReX.H>
+#include <AMReX_Math.H>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace amrex::FFT
+{
+
+namespace {
+
+    constexpr int max_radix = 13;
+
+    // exp(sign * 2 pi i t/n) computed in double precision
+    template <typename T>
+    GpuComplex<T> unit_root (Long t, Long n, Direction dir)
+    {
+        const double theta = 2.0 * Math::pi<double>() * double(t) / double(n);
+        const double s = (dir == Direction::forward) ? -1.0 : 1.0;
+        return GpuComplex<T>(T(std::cos(theta)), T(s*std::sin(theta)));
+    }
+
+    template <typename T>
+    AMREX_FORCE_INLINE GpuComplex<T> conj (GpuComplex<T> const& z)
+    {
+        return GpuComplex<T>(z.real(), -z.imag());
+    }
+
+    // Multiply by exp(sign * i pi/2)
+    template <typename T>
+    AMREX_FORCE_INLINE GpuComplex<T> rotate (GpuComplex<T> const& z, Direction dir)
+    {
+        return (dir == Direction::forward) ? GpuComplex<T>( z.imag(), -z.real())
+                                           : GpuComplex<T>(-z.imag(),  z.real());
+    }
+
+    // Factors of n in the order they are used, or an empty Vector if n has
+    // a prime factor greater than max_radix.
+    Vector<int> factorize (int n)
+    {
+        Vector<int> factors;
+        while (n % 4 == 0) { factors.push_back(4); n /= 4; }
+        for (int p = 2; p <= max_radix && n > 1; ++p) {
+            while (n % p == 0) { factors.push_back(p); n /= p; }
+        }
+        if (n > 1) { factors.clear(); }
+        return factors;
+    }
+}
+
+template <typename T>
+Plan1D<T>::Plan1D (int n, Direction dir)
+    : m_n(n), m_dir(dir)
+{
+    AMREX_ALWAYS_ASSERT(n > 0);
+
+    if (n > 1) {
+        m_factors = factorize(n);
+    }
+
+    if (n == 1 || !m_factors.empty())
+    {
+        m_w.resize(n);
+        for (int t = 0; t < n; ++t) {
+            m_w[t] = unit_root<T>(t, n, dir);
+        }
+    }
+    else
+    {
+        // Bluestein: X_k = c_k sum_t (x_t c_t) conj(c_{k-t}), c_t = exp(sign i pi t^2/n)
+        m_m = 1;
+        while (m_m < 2*n-1) { m_m *= 2; }
+        m_fwd = std::make_unique<Plan1D<T>>(m_m, Direction::forward);
+        m_bwd = std::make_unique<Plan1D<T>>(m_m, Direction::backward);
+
+        m_chirp.resize(n);
+        for (int t = 0; t < n; ++t) {
+            // t^2 mod 2n so that the angle is computed accurately
+            auto t2 = (Long(t)*Long(t)) % (2*Long(n));
+            m_chirp[t] = unit_root<T>(t2, 2*Long(n), dir);
+        }
+
+        m_bhat.resize(m_m, GpuComplex<T>(0));
+        m_bhat[0] = conj(m_chirp[0]);
+        for (int t = 1; t < n; ++t) {
+            m_bhat[t] = m_bhat[m_m-t] = conj(m_chirp[t]);
+        }
+        Vector<GpuComplex<T>> work(m_fwd->workSize());
+        m_fwd->execute(m_bhat.data(), work.data());
+        const T scale = T(1)/T(m_m);
+        for (auto& b : m_bhat) { b *= scale; }
+    }
+}
+
+template <typename T>
+void
+Plan1D<T>::stockham (GpuComplex<T>* x, GpuComplex<T>* y) const
+{
+    const int N = m_n;
+    GpuComplex<T> const* w = m_w.data();
+    GpuComplex<T>* src = x;
+    GpuComplex<T>* dst = y;
+    int n = N;
+    int s = 1;
+    for (int p : m_factors)
+    {
+        // n = p*m.  The s interleaved sequences of length n in src are
+        // turned into s*p interleaved sequences of length m in dst.
+        const int m = n/p;
+        for (int j = 0; j < m; ++j) {
+            for (int q = 0; q < s; ++q) {
+                GpuComplex<T> const* a = src + q + s*j;
+                GpuComplex<T>* b = dst + q + s*p*j;
+                const int sm = s*m;
+                if (p == 4) {
+                    GpuComplex<T> a0 = a[0], a1 = a[sm], a2 = a[2*sm], a3 = a[3*sm];
+                    GpuComplex<T> t0 = a0 + a2, t1 = a0 - a2;
+                    GpuComplex<T> t2 = a1 + a3, t3 = rotate(a1 - a3, m_dir);
+                    b[0]   =  t0 + t2;
+                    b[s]   = (t1 + t3) * w[j*s];
+                    b[2*s] = (t0 - t2) * w[2*j*s];
+                    b[3*s] = (t1 - t3) * w[3*j*s];
+                } else if (p == 2) {
+                    GpuComplex<T> a0 = a[0], a1 = a[sm];
+                    b[0] =  a0 + a1;
+                    b[s] = (a0 - a1) * w[j*s];
+                } else {
+                    GpuComplex<T> ar[max_radix];
+                    for (int r = 0; r < p; ++r) { ar[r] = a[r*sm]; }
+                    const int np = N/p;
+                    for (int u = 0; u < p; ++u) {
+                        GpuComplex<T> bu = ar[0];
+                        for (int r = 1; r < p; ++r) {
+                            bu += ar[r] * w[((r*u)%p)*np];
+                        }
+                        b[u*s] = bu * w[j*u*s];
+                    }
+                }
+            }
+        }
+        n = m;
+        s *= p;
+        std::swap(src, dst);
+    }
+    if (src != x) {
+        std::copy(src, src+N, x);
+    }
+}
+
+template <typename T>
+void
+Plan1D<T>::execute (GpuComplex<T>* data, GpuComplex<T>* work) const
+{
+    if (m_m == 0) {
+        stockham(data, work);
+    } else {
+        GpuComplex<T>* a = work;
+        for (int t = 0; t < m_n; ++t) {
+            a[t] = data[t] * m_chirp[t];
+        }
+        std::fill(a+m_n, a+m_m, GpuComplex<T>(0));
+        m_fwd->execute(a, work+m_m);
+        for (int k = 0; k < m_m; ++k) {
+            a[k] *= m_bhat[k];
+        }
+        m_bwd->execute(a, work+m_m);
+        for (int k = 0; k < m_n; ++k) {
+            data[k] = a[k] * m_chirp[k];
+        }
+    }
+}
+
+template <typename T>
+PlanR2C<T>::PlanR2C (int n, Direction dir)
+    : m_n(n), m_dir(dir), m_plan((n%2 == 0) ? n/2 : n, dir)
+{
+    if (n%2 == 0) {
+        m_w.resize(n/2+1);
+        for (int k = 0; k <= n/2; ++k) {
+            m_w[k] = unit_root<T>(k, n, dir);
+        }
+    }
+}
+
+template <typename T>
+void
+PlanR2C<T>::execute (T* real, GpuComplex<T>* cplx, GpuComplex<T>* work) const
+{
+    const int n = m_n;
+    GpuComplex<T>* z = work;
+    GpuComplex<T>* pwork = work + m_plan.size();
+
+    if (n%2 == 0)
+    {
+        // Even and odd elements as the real and imaginary parts of a
+        // complex sequence of length h.
+        const int h = n/2;
+        if (m_dir == Direction::forward) {
+            for (int t = 0; t < h; ++t) {
+                z[t] = GpuComplex<T>(real[2*t], real[2*t+1]);
+            }
+            m_plan.execute(z, pwork);
+            for (int k = 0; k <= h; ++k) {
+                GpuComplex<T> zk = z[k%h];
+                GpuComplex<T> zc = conj(z[(h-k)%h]);
+                GpuComplex<T> e = (zk + zc) * T(0.5);
+                GpuComplex<T> o = rotate(zk - zc, Direction::forward) * T(0.5);
+                cplx[k] = e + m_w[k] * o;
+            }
+        } else {
+            for (int k = 0; k < h; ++k) {
+                GpuComplex<T> xk = cplx[k];
+                GpuComplex<T> xc = conj(cplx[h-k]);
+                GpuComplex<T> o = (xk - xc) * m_w[k];
+                z[k] = (xk + xc) + rotate(o, Direction::backward);
+            }
+            m_plan.execute(z, pwork);
+            for (int t = 0; t < h; ++t) {
+                real[2*t]   = z[t].real();
+                real[2*t+1] = z[t].imag();
+            }
+        }
+    }
+    else
+    {
+        if (m_dir == Direction::forward) {
+            for (int t = 0; t < n; ++t) {
+                z[t] = GpuComplex<T>(real[t]);
+            }
+            m_plan.execute(z, pwork);
+            std::copy(z, z+n/2+1, cplx);
+        } else {
+            z[0] = cplx[0];
+            for (int k = 1; k <= n/2; ++k) {
+                z[k] = cplx[k];
+                z[n-k] = conj(cplx[k]);
+            }
+            m_plan.execute(z, pwork);
+            for (int t = 0; t < n; ++t) {
+                real[t] = z[t].real();
+            }
+        }
+    }
+}
+
+template class Plan1D<float>;
+template class Plan1D<double>;
+template class PlanR2C<float>;
+template class PlanR2C<double>;
+
+namespace {
+
+    template <typename P>
+    struct PlanCache
+    {
+        std::mutex mutex;
+        std::map<std::pair<int,Direction>,std::unique_ptr<P>> plans;
+    };
+
+    std::atomic<bool> s_initialized{false};
+
+    template <typename P>
+    PlanCache<P>& planCache ()
+    {
+        static PlanCache<P> cache;
+        return cache;
+    }
+
+    template <typename P>
+    P const& getPlan (int n, Direction dir)
+    {
+        auto& cache = planCache<P>();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!s_initialized.exchange(true)) {
+            amrex::ExecOnFinalize(clearPlans);
+        }
+        auto& p = cache.plans[std::make_pair(n,dir)];
+        if (!p) {
+            p = std::make_unique<P>(n, dir);
+        }
+        return *p;
+    }
+
+    template <typename P>
+    void clearPlanCache ()
+    {
+        auto& cache = planCache<P>();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.plans.clear();
+    }
+}
+
+template <typename T>
+Plan1D<T> const& getPlan1D (int n, Direction dir)
+{
+    return getPlan<Plan1D<T>>(n, dir);
+}
+
+template <typename T>
+PlanR2C<T> const& getPlanR2C (int n, Direction dir)
+{
+    return getPlan<PlanR2C<T>>(n, dir);
+}
+
+template Plan1D<float> const& getPlan1D<float> (int, Direction);
+template Plan1D<double> const& getPlan1D<double> (int, Direction);
+template PlanR2C<float> const& getPlanR2C<float> (int, Direction);
+template PlanR2C<double> const& getPlanR2C<double> (int, Direction);
+
+void clearPlans ()
+{
+    clearPlanCache<Plan1D<float>>();
+    clearPlanCache<Plan1D<double>>();
+    clearPlanCache<PlanR2C<float>>();
+    clearPlanCache<PlanR2C<double>>();
+    s_initialized = false;
+}
+
+}
@@ -0,0 +1,616 @@
+#include <AMReX_AMG.H>
+#include <AMReX.H>
+#include <AMReX_BLProfiler.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace amrex {
+
+namespace {
+
+using Matrix = AMG::Matrix;
+
+// y = A x
+void matvec (Matrix const& A, Vector<Real> const& x, Vector<Real>& y)
+{
+    for (int i = 0; i < A.nrows; ++i) {
+        Real s = 0;
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            s += A.val[jj] * x[A.col[jj]];
+        }
+        y[i] = s;
+    }
+}
+
+// r = b - A x
+void residual (Matrix const& A, Vector<Real> const& x, Vector<Real> const& b, Vector<Real>& r)
+{
+    for (int i = 0; i < A.nrows; ++i) {
+        Real s = b[i];
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            s -= A.val[jj] * x[A.col[jj]];
+        }
+        r[i] = s;
+    }
+}
+
+Real dot (Vector<Real> const& x, Vector<Real> const& y)
+{
+    return std::inner_product(x.begin(), x.end(), y.begin(), Real(0.0));
+}
+
+Real norminf (Vector<Real> const& x)
+{
+    Real r = 0;
+    for (auto v : x) { r = std::max(r, std::abs(v)); }
+    return r;
+}
+
+Matrix transpose (Matrix const& A)
+{
+    Matrix T;
+    T.nrows = A.ncols;
+    T.ncols = A.nrows;
+    T.ptr.assign(T.nrows+1, 0);
+    for (int jj = 0; jj < A.ptr[A.nrows]; ++jj) {
+        ++T.ptr[A.col[jj]+1];
+    }
+    for (int i = 0; i < T.nrows; ++i) {
+        T.ptr[i+1] += T.ptr[i];
+    }
+    const int nnz = T.ptr[T.nrows];
+    T.col.resize(nnz);
+    T.val.resize(nnz);
+    Vector<int> pos(T.ptr.begin(), T.ptr.end()-1);
+    for (int i = 0; i < A.nrows; ++i) {
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            const int p = pos[A.col[jj]]++;
+            T.col[p] = i;
+            T.val[p] = A.val[jj];
+        }
+    }
+    return T;
+}
+
+// C = A * B
+Matrix matmul (Matrix const& A, Matrix const& B)
+{
+    Matrix C;
+    C.nrows = A.nrows;
+    C.ncols = B.ncols;
+    C.ptr.assign(C.nrows+1, 0);
+
+    Vector<int> marker(B.ncols, -1);
+    Vector<Real> acc(B.ncols, Real(0.0));
+    Vector<int> cols;
+    for (int i = 0; i < A.nrows; ++i) {
+        cols.clear();
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            const int k = A.col[jj];
+            const Real a = A.val[jj];
+            for (int kk = B.ptr[k]; kk < B.ptr[k+1]; ++kk) {
+                const int j = B.col[kk];
+                if (marker[j] != i) {
+                    marker[j] = i;
+                    acc[j] = Real(0.0);
+                    cols.push_back(j);
+                }
+                acc[j] += a * B.val[kk];
+            }
+        }
+        std::sort(cols.begin(), cols.end());
+        for (int j : cols) {
+            if (acc[j] != Real(0.0)) {
+                C.col.push_back(j);
+                C.val.push_back(acc[j]);
+            }
+        }
+        C.ptr[i+1] = static_cast<int>(C.col.size());
+    }
+    return C;
+}
+
+}
+
+void
+AMG::define (Matrix a_A)
+{
+    BL_PROFILE("AMG::define()");
+
+    AMREX_ALWAYS_ASSERT(a_A.nrows == a_A.ncols &&
+                        static_cast<int>(a_A.ptr.size()) == a_A.nrows+1);
+
+    // Sort the columns of each row and make empty rows identity rows.
+    Matrix A;
+    A.nrows = A.ncols = a_A.nrows;
+    A.ptr.assign(A.nrows+1, 0);
+    Vector<int> idx;
+    for (int i = 0; i < a_A.nrows; ++i) {
+        idx.clear();
+        for (int jj = a_A.ptr[i]; jj < a_A.ptr[i+1]; ++jj) {
+            if (a_A.val[jj] != Real(0.0)) { idx.push_back(jj); }
+        }
+        if (idx.empty()) {
+            A.col.push_back(i);
+            A.val.push_back(Real(1.0));
+        } else {
+            std::sort(idx.begin(), idx.end(),
+                      [&] (int a, int b) { return a_A.col[a] < a_A.col[b]; });
+            for (int jj : idx) {
+                A.col.push_back(a_A.col[jj]);
+                A.val.push_back(a_A.val[jj]);
+            }
+        }
+        A.ptr[i+1] = static_cast<int>(A.col.size());
+    }
+
+    {
+        Matrix const At = transpose(A);
+        const Real amax = norminf(A.val);
+        m_symmetric = (At.ptr == A.ptr) && (At.col == A.col);
+        for (int jj = 0; m_symmetric && jj < A.ptr[A.nrows]; ++jj) {
+            m_symmetric = std::abs(A.val[jj]-At.val[jj]) <= Real(1.e-10)*amax;
+        }
+    }
+
+    m_A.clear();
+    m_P.clear();
+    m_R.clear();
+    m_diag.clear();
+    m_A.push_back(std::move(A));
+
+    for (int lev = 0; lev < m_max_levels-1; ++lev) {
+        if (m_A[lev].nrows <= m_max_coarse_size) { break; }
+        buildLevel(lev);
+        if (static_cast<int>(m_A.size()) == lev+1) { break; } // no more coarsening
+    }
+
+    const int nlevs = numLevels();
+    m_diag.resize(nlevs);
+    m_res.resize(nlevs);
+    m_cor.resize(nlevs);
+    m_rhs.resize(nlevs);
+    for (int lev = 0; lev < nlevs; ++lev) {
+        auto const& Al = m_A[lev];
+        m_diag[lev].assign(Al.nrows, Real(0.0));
+        for (int i = 0; i < Al.nrows; ++i) {
+            for (int jj = Al.ptr[i]; jj < Al.ptr[i+1]; ++jj) {
+                if (Al.col[jj] == i) { m_diag[lev][i] = Al.val[jj]; }
+            }
+        }
+        m_res[lev].resize(Al.nrows);
+        m_cor[lev].resize(Al.nrows);
+        m_rhs[lev].resize(Al.nrows);
+    }
+
+    factorCoarsest();
+
+    if (m_verbose > 0) {
+        amrex::Print() << "AMG: " << nlevs << " levels, rows:";
+        for (auto const& Al : m_A) { amrex::Print() << " " << Al.nrows; }
+        amrex::Print() << ", nonzeros:";
+        for (auto const& Al : m_A) { amrex::Print() << " " << Al.ptr[Al.nrows]; }
+        amrex::Print() << (m_symmetric ? ", symmetric\n" : ", nonsymmetric\n");
+    }
+}
+
+void
+AMG::buildLevel (int lev)
+{
+    auto const& A = m_A[lev];
+    const int n = A.nrows;
+
+    Vector<Real> diag(n, Real(0.0));
+    for (int i = 0; i < n; ++i) {
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            if (A.col[jj] == i) { diag[i] = A.val[jj]; }
+        }
+    }
+
+    // Strong connections: a_ij^2 >= theta^2 |a_ii a_jj|
+    const Real theta2 = m_theta*m_theta;
+    auto strong = [&] (int i, int jj) -> bool
+    {
+        const int j = A.col[jj];
+        return j != i && A.val[jj]*A.val[jj] >= theta2*std::abs(diag[i]*diag[j]);
+    };
+
+    // Aggregation.  Rows without off-diagonal entries are left out of
+    // the coarse level, because the smoother solves them exactly.
+    constexpr int unagg = -1;
+    constexpr int decoupled = -2;
+    Vector<int> agg(n, unagg);
+    for (int i = 0; i < n; ++i) {
+        if (A.ptr[i+1]-A.ptr[i] == 1 && A.col[A.ptr[i]] == i) { agg[i] = decoupled; }
+    }
+
+    int nagg = 0;
+    // Pass 1: a node whose strong neighbors are all free forms a new aggregate.
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] != unagg) { continue; }
+        bool free = true;
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1] && free; ++jj) {
+            if (strong(i,jj) && agg[A.col[jj]] != unagg) { free = false; }
+        }
+        if (free) {
+            agg[i] = nagg;
+            for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+                if (strong(i,jj)) { agg[A.col[jj]] = nagg; }
+            }
+            ++nagg;
+        }
+    }
+    // Pass 2: join the aggregate of the strongest aggregated neighbor.
+    Vector<int> agg1 = agg;
+    for (int i = 0; i < n; ++i) {
+        if (agg1[i] != unagg) { continue; }
+        Real amax = 0;
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            if (strong(i,jj) && agg1[A.col[jj]] >= 0 && std::abs(A.val[jj]) > amax) {
+                amax = std::abs(A.val[jj]);
+                agg[i] = agg1[A.col[jj]];
+            }
+        }
+    }
+    // Pass 3: the remaining nodes and their free strong neighbors.
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] != unagg) { continue; }
+        agg[i] = nagg;
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            if (strong(i,jj) && agg[A.col[jj]] == unagg) { agg[A.col[jj]] = nagg; }
+        }
+        ++nagg;
+    }
+
+    if (nagg == 0 || nagg > (n*9)/10) { return; } // coarsening has stalled
+
+    // Tentative prolongation
+    Matrix P0;
+    P0.nrows = n;
+    P0.ncols = nagg;
+    P0.ptr.assign(n+1, 0);
+    for (int i = 0; i < n; ++i) {
+        if (agg[i] >= 0) {
+            P0.col.push_back(agg[i]);
+            P0.val.push_back(Real(1.0));
+        }
+        P0.ptr[i+1] = static_cast<int>(P0.col.size());
+    }
+
+    // Smoothed prolongation, P = (I - omega D^{-1} A) P0, with omega = 4/(3 rho)
+    // and rho bounded by the Gershgorin circles of D^{-1} A.
+    Real rho = 0;
+    for (int i = 0; i < n; ++i) {
+        if (diag[i] != Real(0.0)) {
+            Real s = 0;
+            for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) { s += std::abs(A.val[jj]); }
+            rho = std::max(rho, s/std::abs(diag[i]));
+        }
+    }
+    const Real omega = (rho > Real(0.0)) ? Real(4.0)/(Real(3.0)*rho) : Real(0.0);
+
+    Matrix AP0 = matmul(A, P0);
+    Matrix P;
+    P.nrows = n;
+    P.ncols = nagg;
+    P.ptr.assign(n+1, 0);
+    for (int i = 0; i < n; ++i) {
+        const Real s = (diag[i] != Real(0.0)) ? omega/diag[i] : Real(0.0);
+        int kk = AP0.ptr[i];
+        const int kend = AP0.ptr[i+1];
+        const int j0 = (agg[i] >= 0) ? agg[i] : -1;
+        bool j0_done = (j0 < 0);
+        for (; kk < kend; ++kk) {
+            const int j = AP0.col[kk];
+            if (!j0_done && j0 < j) {
+                P.col.push_back(j0);
+                P.val.push_back(Real(1.0));
+                j0_done = true;
+            }
+            Real v = -s*AP0.val[kk];
+            if (j == j0) {
+                v += Real(1.0);
+                j0_done = true;
+            }
+            if (v != Real(0.0)) {
+                P.col.push_back(j);
+                P.val.push_back(v);
+            }
+        }
+        if (!j0_done) {
+            P.col.push_back(j0);
+            P.val.push_back(Real(1.0));
+        }
+        P.ptr[i+1] = static_cast<int>(P.col.size());
+    }
+
+    Matrix R = transpose(P);
+    Matrix Ac = matmul(R, matmul(A, P));
+
+    m_P.push_back(std::move(P));
+    m_R.push_back(std::move(R));
+    m_A.push_back(std::move(Ac));
+}
+
+void
+AMG::factorCoarsest ()
+{
+    auto const& A = m_A.back();
+    const int n = A.nrows;
+
+    // A dense factorization is only affordable for a small coarsest level.
+    // Otherwise, which happens if the coarsening has stalled, many
+    // smoother sweeps are used instead.
+    m_coarsest_direct = (n <= std::max(m_max_coarse_size,1024));
+    if (!m_coarsest_direct) {
+        m_lu.clear();
+        m_piv.clear();
+        m_zero_pivot.clear();
+        return;
+    }
+
+    m_lu.assign(std::size_t(n)*n, Real(0.0));
+    for (int i = 0; i < n; ++i) {
+        for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+            m_lu[std::size_t(i)*n+A.col[jj]] = A.val[jj];
+        }
+    }
+    m_piv.resize(n);
+    std::iota(m_piv.begin(), m_piv.end(), 0);
+    m_zero_pivot.assign(n, 0);
+
+    const Real tiny = Real(1.e-12) * norminf(A.val);
+
+    // LU with partial pivoting.  A zero pivot, as in singular problems, is
+    // skipped and the corresponding unknown is set to zero in the solve.
+    for (int k = 0; k < n; ++k) {
+        int imax = k;
+        Real amax = std::abs(m_lu[std::size_t(k)*n+k]);
+        for (int i = k+1; i < n; ++i) {
+            if (std::abs(m_lu[std::size_t(i)*n+k]) > amax) {
+                amax = std::abs(m_lu[std::size_t(i)*n+k]);
+                imax = i;
+            }
+        }
+        if (amax <= tiny) {
+            m_zero_pivot[k] = 1;
+            continue;
+        }
+        if (imax != k) {
+            std::swap_ranges(m_lu.begin()+std::size_t(k)*n, m_lu.begin()+std::size_t(k+1)*n,
+                             m_lu.begin()+std::size_t(imax)*n);
+            std::swap(m_piv[k], m_piv[imax]);
+        }
+        const Real pinv = Real(1.0)/m_lu[std::size_t(k)*n+k];
+        for (int i = k+1; i < n; ++i) {
+            Real& lik = m_lu[std::size_t(i)*n+k];
+            if (lik != Real(0.0)) {
+                lik *= pinv;
+                for (int j = k+1; j < n; ++j) {
+                    m_lu[std::size_t(i)*n+j] -= lik * m_lu[std::size_t(k)*n+j];
+                }
+            }
+        }
+    }
+}
+
+void
+AMG::solveCoarsest (Vector<Real>& x, Vector<Real> const& b) const
+{
+    const int n = m_A.back().nrows;
+    for (int i = 0; i < n; ++i) {
+        Real s = b[m_piv[i]];
+        for (int j = 0; j < i; ++j) {
+            s -= m_lu[std::size_t(i)*n+j] * x[j];
+        }
+        x[i] = s;
+    }
+    for (int i = n-1; i >= 0; --i) {
+        if (m_zero_pivot[i]) {
+            x[i] = Real(0.0);
+        } else {
+            Real s = x[i];
+            for (int j = i+1; j < n; ++j) {
+                s -= m_lu[std::size_t(i)*n+j] * x[j];
+            }
+            x[i] = s / m_lu[std::size_t(i)*n+i];
+        }
+    }
+}
+
+void
+AMG::vcycle (int lev, Vector<Real>& x, Vector<Real> const& b)
+{
+    auto const& A = m_A[lev];
+    auto const& diag = m_diag[lev];
+    const int n = A.nrows;
+
+    auto gs = [&] (int i)
+    {
+        if (diag[i] != Real(0.0)) {
+            Real s = b[i];
+            for (int jj = A.ptr[i]; jj < A.ptr[i+1]; ++jj) {
+                s -= A.val[jj] * x[A.col[jj]];
+            }
+            x[i] += s / diag[i];
+        }
+    };
+
+    const bool coarsest = (lev == numLevels()-1);
+    if (coarsest && m_coarsest_direct) {
+        solveCoarsest(x, b);
+        return;
+    }
+
+    const int nsweeps = coarsest ? 20 : m_nsweeps;
+    for (int is = 0; is < nsweeps; ++is) {
+        for (int i = 0; i < n; ++i) { gs(i); }
+    }
+
+    if (!coarsest) {
+        auto& r = m_res[lev];
+        auto& cb = m_rhs[lev+1];
+        auto& cx = m_cor[lev+1];
+        residual(A, x, b, r);
+        matvec(m_R[lev], r, cb);
+        std::fill(cx.begin(), cx.end(), Real(0.0));
+        vcycle(lev+1, cx, cb);
+        auto const& P = m_P[lev];
+        for (int i = 0; i < n; ++i) {
+            Real s = 0;
+            for (int jj = P.ptr[i]; jj < P.ptr[i+1]; ++jj) {
+                s += P.val[jj] * cx[P.col[jj]];
+            }
+            x[i] += s;
+        }
+    }
+
+    // Backward sweeps keep the V-cycle symmetric for CG.
+    for (int is = 0; is < nsweeps; ++is) {
+        for (int i = n-1; i >= 0; --i) { gs(i); }
+    }
+}
+
+void
+AMG::precond (Vector<Real>& x, Vector<Real> const& r)
+{
+    std::fill(x.begin(), x.end(), Real(0.0));
+    vcycle(0, x, r);
+}
+
+int
+AMG::solve (Vector<Real>& x, Vector<Real> const& b, Real reltol, Real abstol, int maxiter)
+{
+    BL_PROFILE("AMG::solve()");
+
+    AMREX_ALWAYS_ASSERT(isDefined() &&
+                        static_cast<int>(x.size()) == m_A[0].nrows &&
+                        static_cast<int>(b.size()) == m_A[0].nrows);
+
+    if (m_symmetric) {
+        return solveCG(x, b, reltol, abstol, maxiter);
+    } else {
+        return solveBiCGStab(x, b, reltol, abstol, maxiter);
+    }
+}
+
+int
+AMG::solveCG (Vector<Real>& x, Vector<Real> const& b, Real reltol, Real abstol, int maxiter)
+{
+    auto const& A = m_A[0];
+    const int n = A.nrows;
+    Vector<Real> r(n), z(n), p(n), q(n);
+
+    residual(A, x, b, r);
+    const Real rnorm0 = norminf(r);
+    const Real target = std::max(abstol, reltol*rnorm0);
+    m_niters = 0;
+    if (rnorm0 <= target) { return 0; }
+
+    precond(z, r);
+    p = z;
+    Real rho = dot(r, z);
+
+    int ret = 1;
+    for (int iter = 1; iter <= maxiter; ++iter) {
+        matvec(A, p, q);
+        const Real pq = dot(p, q);
+        if (pq == Real(0.0)) { ret = 2; break; }
+        const Real alpha = rho / pq;
+        for (int i = 0; i < n; ++i) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+        }
+        m_niters = iter;
+        const Real rnorm = norminf(r);
+        if (m_verbose > 1) {
+            amrex::Print() << "AMG: CG iteration " << iter << " rnorm " << rnorm << "\n";
+        }
+        if (rnorm <= target) { ret = 0; break; }
+
+        precond(z, r);
+        const Real rho_new = dot(r, z);
+        const Real beta = rho_new / rho;
+        for (int i = 0; i < n; ++i) {
+            p[i] = z[i] + beta * p[i];
+        }
+        rho = rho_new;
+    }
+
+    if (m_verbose > 0) {
+        amrex::Print() << "AMG: CG " << (ret == 0 ? "converged" : "failed")
+                       << " after " << m_niters << " iterations\n";
+    }
+    return ret;
+}
+
+int
+AMG::solveBiCGStab (Vector<Real>& x, Vector<Real> const& b, Real reltol, Real abstol, int maxiter)
+{
+    auto const& A = m_A[0];
+    const int n = A.nrows;
+    Vector<Real> r(n), rh(n), p(n, Real(0.0)), v(n, Real(0.0)), ph(n), s(n), sh(n), t(n);
+
+    residual(A, x, b, r);
+    const Real rnorm0 = norminf(r);
+    const Real target = std::max(abstol, reltol*rnorm0);
+    m_niters = 0;
+    if (rnorm0 <= target) { return 0; }
+
+    rh = r;
+    Real rho = 1, alpha = 1, omega = 1;
+
+    int ret = 1;
+    for (int iter = 1; iter <= maxiter; ++iter) {
+        const Real rho_new = dot(rh, r);
+        if (rho_new == Real(0.0)) { ret = 2; break; }
+        if (iter == 1) {
+            p = r;
+        } else {
+            const Real beta = (rho_new/rho)*(alpha/omega);
+            for (int i = 0; i < n; ++i) {
+                p[i] = r[i] + beta*(p[i] - omega*v[i]);
+            }
+        }
+        precond(ph, p);
+        matvec(A, ph, v);
+        const Real rhv = dot(rh, v);
+        if (rhv == Real(0.0)) { ret = 2; break; }
+        alpha = rho_new / rhv;
+        for (int i = 0; i < n; ++i) {
+            x[i] += alpha * ph[i];
+            s[i] = r[i] - alpha * v[i];
+        }
+        m_niters = iter;
+        if (norminf(s) <= target) { ret = 0; break; }
+
+        precond(sh, s);
+        matvec(A, sh, t);
+        const Real tt = dot(t, t);
+        if (tt == Real(0.0)) { ret = 2; break; }
+        omega = dot(t, s) / tt;
+        for (int i = 0; i < n; ++i) {
+            x[i] += omega * sh[i];
+            r[i] = s[i] - omega * t[i];
+        }
+        const Real rnorm = norminf(r);
+        if (m_verbose > 1) {
+            amrex::Print() << "AMG: BiCGStab iteration " << iter << " rnorm " << rnorm << "\n";
+        }
+        if (rnorm <= target) { ret = 0; break; }
+        if (omega == Real(0.0)) { ret = 2; break; }
+        rho = rho_new;
+    }
+
+    if (m_verbose > 0) {
+        amrex::Print() << "AMG: BiCGStab " << (ret == 0 ? "converged" : "failed")
+                       << " after " << m_niters << " iterations\n";
+    }
+    return ret;
+}
+
+}
@@ -397,6 +397,8 @@ MLNodeLaplacian::setSigma (int amrlev, const MultiFab& a_sigma)
     } else {
         MultiFab::Copy(*m_sigma[amrlev][0][0], a_sigma, 0, 0, 1, 0);
     }
+
+    m_needs_update = true;
 }
 
 void
@@ -464,6 +466,24 @@ MLNodeLaplacian::prepareForSolve ()
 #endif
 
     buildStencil();
+
+    m_needs_update = false;
+}
+
+void
+MLNodeLaplacian::update ()
+{
+    BL_PROFILE("MLNodeLaplacian::update()");
+
+    if (MLNodeLinOp::needsUpdate()) { MLNodeLinOp::update(); }
+
+    // Only sigma has changed.  The masks and the EB integrals depend on
+    // the grids and are kept.
+    averageDownCoeffs();
+
+    buildStencil();
+
+    m_needs_update = false;
 }
 
 void
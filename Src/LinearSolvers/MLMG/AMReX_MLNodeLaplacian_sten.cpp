@@ -38,17 +38,22 @@ MLNodeLaplacian::buildStencil ()
         AMREX_ALWAYS_ASSERT(amrlev == m_num_amr_levels-1 || AMRRefRatio(amrlev) == 2);
         for (int mglev = 0; mglev < m_num_mg_levels[amrlev]; ++mglev)
         {
-            const int nghost = (0 == amrlev && mglev+1 == m_num_mg_levels[amrlev]) ? 1 : 4;
-            m_stencil[amrlev][mglev] = std::make_unique<MultiFab>
-                (amrex::convert(m_grids[amrlev][mglev], IntVect::TheNodeVector()),
-                 m_dmap[amrlev][mglev], ncomp_s, nghost);
+            // Keep the allocation if the stencil is rebuilt by update()
+            if (m_stencil[amrlev][mglev] == nullptr) {
+                const int nghost = (0 == amrlev && mglev+1 == m_num_mg_levels[amrlev]) ? 1 : 4;
+                m_stencil[amrlev][mglev] = std::make_unique<MultiFab>
+                    (amrex::convert(m_grids[amrlev][mglev], IntVect::TheNodeVector()),
+                     m_dmap[amrlev][mglev], ncomp_s, nghost);
+            }
             m_stencil[amrlev][mglev]->setVal(0.0);
         }
 
         if (amrlev > 0) {
-            m_nosigma_stencil[amrlev] = std::make_unique<MultiFab>
-                (amrex::convert(m_grids[amrlev][0], IntVect::TheNodeVector()),
-                 m_dmap[amrlev][0], ncomp_s, 4);
+            if (m_nosigma_stencil[amrlev] == nullptr) {
+                m_nosigma_stencil[amrlev] = std::make_unique<MultiFab>
+                    (amrex::convert(m_grids[amrlev][0], IntVect::TheNodeVector()),
+                     m_dmap[amrlev][0], ncomp_s, 4);
+            }
             m_nosigma_stencil[amrlev]->setVal(0.0);
         }
 
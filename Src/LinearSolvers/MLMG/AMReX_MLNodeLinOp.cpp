@@ -169,6 +169,12 @@ void
 MLNodeLinOp::smooth (int amrlev, int mglev, MultiFab& sol, const MultiFab& rhs,
                      bool skip_fillboundary) const
 {
+    if (m_use_chebyshev) {
+        chebyshevSmooth(amrlev, mglev, sol, rhs);
+        setDirichletNodesToZero(amrlev, mglev, sol);
+        nodalSync(amrlev, mglev, sol);
+        return;
+    }
     if (!skip_fillboundary) {
         applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Correction);
     }
@@ -228,6 +228,12 @@ MLNodeTensorLaplacian::smooth (int amrlev, int mglev, MultiFab& sol, const Multi
                                bool skip_fillboundary) const
 {
     BL_PROFILE("MLNodeTensorLaplacian::smooth()");
+    if (m_use_chebyshev) {
+        chebyshevSmooth(amrlev, mglev, sol, rhs);
+        setDirichletNodesToZero(amrlev, mglev, sol);
+        nodalSync(amrlev, mglev, sol);
+        return;
+    }
     for (int redblack = 0; redblack < 4; ++redblack) {
         if (!skip_fillboundary) {
             applyBC(amrlev, mglev, sol, BCMode::Homogeneous, StateMode::Correction);
@@ -202,6 +202,11 @@ void OpenBCSolver::useHypre (bool use_hypre) noexcept
     }
 }
 
+void OpenBCSolver::setOpeningAngle (Real theta) noexcept
+{
+    m_opening_angle = theta;
+}
+
 Real OpenBCSolver::solve (const Vector<MultiFab*>& a_sol,
                           const Vector<MultiFab const*>& a_rhs,
                           Real a_tol_rel, Real a_tol_abs)
@@ -662,77 +667,295 @@ void OpenBCSolver::compute_moments (Gpu::DeviceVector<openbc::Moments>& moments)
         }
     }
 #endif
+}
 
-#ifdef AMREX_USE_MPI
-    bcast_moments(moments);
-#endif
-    m_nblocks = static_cast<int>(moments.size());
+namespace {
+
+    // In-plane coordinate of the center of a block of moments.
+    Real& mom_coord (openbc::Moments& mom, int idim)
+    {
+        return (idim == 0) ? mom.x : ((idim == 1) ? mom.y : mom.z);
+    }
+
+    // Add the moments in src, shifted by (da,db) in the plane of the face, to
+    // dst.  Because the moments are scaled by 1/(p!q!), the binomial
+    // coefficients reduce to products of da^n/n! and db^n/n!.
+    void add_shifted_moments (openbc::Moments::array_type const& src, Real da, Real db,
+                              openbc::Moments::array_type& dst)
+    {
+        constexpr int M = openbc::M;
+        Real fa[M+1], fb[M+1];
+        fa[0] = 1._rt;
+        fb[0] = 1._rt;
+        for (int n = 1; n <= M; ++n) {
+            fa[n] = fa[n-1]*da/static_cast<Real>(n);
+            fb[n] = fb[n-1]*db/static_cast<Real>(n);
+        }
+        auto idx = [] (int p, int q) { return q*(M+1) - (q*(q-1))/2 + p; };
+        for (int q = 0; q <= M; ++q) {
+        for (int p = 0; p <= M-q; ++p) {
+            Real m = 0._rt;
+            for (int t = 0; t <= q; ++t) {
+            for (int s = 0; s <= p; ++s) {
+                m += src[idx(s,t)] * fa[p-s] * fb[q-t];
+            }}
+            dst[idx(p,q)] += m;
+        }}
+    }
 }
 
-#ifdef AMREX_USE_MPI
-void OpenBCSolver::bcast_moments (Gpu::DeviceVector<openbc::Moments>& moments)
+void OpenBCSolver::build_moment_tree (openbc::Moments const* leaves)
 {
-    if (ParallelContext::NProcsSub() > 1)
-    {
-        MPI_Comm comm = ParallelContext::CommunicatorSub();
-        if (m_nblocks == 0) {
-            int count = static_cast<int>(moments.size() * sizeof(openbc::Moments));
-            m_countvec.resize(ParallelContext::NProcsSub());
-            MPI_Allgather(&count, 1, MPI_INT, m_countvec.data(), 1, MPI_INT, comm);
-
-            m_offset.resize(m_countvec.size(), 0);
-            Long count_tot = m_countvec[0];
-            for (int i = 1, N = static_cast<int>(m_offset.size()); i < N; ++i) {
-                m_offset[i] = m_offset[i-1] + m_countvec[i-1];
-                count_tot += m_countvec[i];
-            }
+    BL_PROFILE("OpenBCSolver::build_tree()");
 
-            if (count_tot > static_cast<Long>(std::numeric_limits<int>::max())) {
-                amrex::Abort("OpenBC: integer overflow. Let us know and we will fix this.");
-            }
+    auto const dx = m_geom[0].CellSizeArray();
+
+    m_tree.clear();
+    m_tree_roots.clear();
 
-            m_nblocks = static_cast<int>(count_tot/sizeof(openbc::Moments));
+    for (auto const& tag : m_momtags_h) {
+        const int idir = tag.face.coordDir();
+        const int adir = (idir == 0) ? 1 : 0;
+        const int bdir = (idir == 2) ? 1 : 2;
+        int na = tag.b2d.length(adir) / m_coarsen_ratio;
+        int nb = tag.b2d.length(bdir) / m_coarsen_ratio;
+        const Real ha = 0.5_rt*static_cast<Real>(m_coarsen_ratio)*dx[adir];
+        const Real hb = 0.5_rt*static_cast<Real>(m_coarsen_ratio)*dx[bdir];
+
+        // Nodes of the current level of the tree and the regions they cover
+        // in the plane of the face.
+        Vector<int> level(na*nb);
+        Vector<std::array<Real,4>> region(na*nb);
+        for (int n = 0; n < na*nb; ++n) {
+            openbc::Moments mom = leaves[tag.offset+n];
+            Real ac = mom_coord(mom, adir);
+            Real bc = mom_coord(mom, bdir);
+            region[n] = {ac-ha, ac+ha, bc-hb, bc+hb};
+            level[n] = static_cast<int>(m_tree.size());
+            m_tree.push_back({mom, std::sqrt(ha*ha+hb*hb)});
         }
 
-        Gpu::DeviceVector<openbc::Moments> moments_all(m_nblocks);
+        while (na > 1 || nb > 1) {
+            const int na2 = (na+1)/2;
+            const int nb2 = (nb+1)/2;
+            Vector<int> parent_level(na2*nb2);
+            Vector<std::array<Real,4>> parent_region(na2*nb2);
+            for (int jb = 0; jb < nb2; ++jb) {
+            for (int ib = 0; ib < na2; ++ib) {
+                openbc::MomNode node;
+                std::array<Real,4> reg{std::numeric_limits<Real>::max(),
+                                       std::numeric_limits<Real>::lowest(),
+                                       std::numeric_limits<Real>::max(),
+                                       std::numeric_limits<Real>::lowest()};
+                int nc = 0;
+                for (int jc = 2*jb; jc < std::min(2*jb+2,nb); ++jc) {
+                for (int ic = 2*ib; ic < std::min(2*ib+2,na); ++ic) {
+                    auto const& creg = region[ic+jc*na];
+                    reg[0] = std::min(reg[0], creg[0]);
+                    reg[1] = std::max(reg[1], creg[1]);
+                    reg[2] = std::min(reg[2], creg[2]);
+                    reg[3] = std::max(reg[3], creg[3]);
+                    node.child[nc++] = level[ic+jc*na];
+                }}
 
-#ifdef AMREX_USE_GPU
-        Gpu::PinnedVector<openbc::Moments> h_moments(moments.size());
-        Gpu::PinnedVector<openbc::Moments> h_moments_all(moments_all.size());
-        Gpu::copyAsync(Gpu::deviceToHost, moments.begin(), moments.end(),
-                       h_moments.begin());
-        Gpu::streamSynchronize();
-#else
-        auto const& h_moments = moments;
-        auto& h_moments_all = moments_all;
-#endif
+                Real ac = 0.5_rt*(reg[0]+reg[1]);
+                Real bc = 0.5_rt*(reg[2]+reg[3]);
+                node.mom = m_tree[node.child[0]].mom;
+                mom_coord(node.mom, adir) = ac;
+                mom_coord(node.mom, bdir) = bc;
+                for (auto& m : node.mom.mom) {
+                    m = 0._rt;
+                }
+                for (int c = 0; c < nc; ++c) {
+                    openbc::Moments cmom = m_tree[node.child[c]].mom;
+                    add_shifted_moments(cmom.mom, mom_coord(cmom,adir)-ac,
+                                        mom_coord(cmom,bdir)-bc, node.mom.mom);
+                }
+                node.radius = 0.5_rt*std::sqrt((reg[1]-reg[0])*(reg[1]-reg[0]) +
+                                               (reg[3]-reg[2])*(reg[3]-reg[2]));
 
-        int count = m_nblocks_local*static_cast<int>(sizeof(openbc::Moments));
-        MPI_Allgatherv(h_moments.data(), count, MPI_CHAR, h_moments_all.data(),
-                       m_countvec.data(), m_offset.data(), MPI_CHAR, comm);
+                parent_level[ib+jb*na2] = static_cast<int>(m_tree.size());
+                parent_region[ib+jb*na2] = reg;
+                m_tree.push_back(node);
+            }}
+            level = std::move(parent_level);
+            region = std::move(parent_region);
+            na = na2;
+            nb = nb2;
+        }
 
-#ifdef AMREX_USE_GPU
-        Gpu::copyAsync(Gpu::hostToDevice, h_moments_all.begin(), h_moments_all.end(),
-                       moments_all.begin());
-        Gpu::streamSynchronize();
-#endif
+        if (!level.empty()) {
+            m_tree_roots.push_back(level[0]);
+        }
+    }
+}
+
+void OpenBCSolver::gather_interactions (Box const& target,
+                                        Vector<openbc::Moments>& list) const
+{
+    auto const problo = m_geom[0].ProbLoArray();
+    auto const dx     = m_geom[0].CellSizeArray();
 
-        std::swap(moments, moments_all);
+    // The target points are the coarse nodes in the box.
+    Real lo[AMREX_SPACEDIM], hi[AMREX_SPACEDIM];
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        lo[idim] = problo[idim] + static_cast<Real>(target.smallEnd(idim)*m_coarsen_ratio)*dx[idim];
+        hi[idim] = problo[idim] + static_cast<Real>(target.bigEnd(idim)*m_coarsen_ratio)*dx[idim];
+    }
+
+    const Real theta2 = m_opening_angle*m_opening_angle;
+    Vector<int> stack(m_tree_roots.begin(), m_tree_roots.end());
+    while (!stack.empty()) {
+        auto const& node = m_tree[stack.back()];
+        stack.pop_back();
+        const Real c[] = {node.mom.x, node.mom.y, node.mom.z};
+        Real d2 = 0._rt;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            Real e = amrex::max(0._rt, lo[idim]-c[idim], c[idim]-hi[idim]);
+            d2 += e*e;
+        }
+        if (node.child[0] < 0 || node.radius*node.radius <= theta2*d2) {
+            list.push_back(node.mom);
+        } else {
+            for (int ichild : node.child) {
+                if (ichild >= 0) { stack.push_back(ichild); }
+            }
+        }
     }
 }
-#endif
 
 void OpenBCSolver::compute_potential (Gpu::DeviceVector<openbc::Moments> const& moments)
 {
     BL_PROFILE("OpenBCSolver::comp_phi()");
 
+#ifdef AMREX_USE_GPU
+    Gpu::PinnedVector<openbc::Moments> h_moments(moments.size());
+    Gpu::copyAsync(Gpu::deviceToHost, moments.begin(), moments.end(),
+                   h_moments.begin());
+    Gpu::streamSynchronize();
+#else
+    auto const& h_moments = moments;
+#endif
+
+    build_moment_tree(h_moments.data());
+
+    // For each target box, collect the nodes of the local trees it needs and
+    // send them to the owner of the box.
+    BoxArray const& tba = m_crse_grown_faces_phi.boxArray();
+    DistributionMapping const& tdm = m_crse_grown_faces_phi.DistributionMap();
+    const int nprocs = ParallelContext::NProcsSub();
+    const int myproc = ParallelContext::MyProcSub();
+    Vector<Vector<int>> rank_boxes(nprocs);
+    for (int ibox = 0, N = static_cast<int>(tba.size()); ibox < N; ++ibox) {
+        rank_boxes[ParallelContext::global_to_local_rank(tdm[ibox])].push_back(ibox);
+    }
+
+    Vector<int> snd_counts;
+    Vector<openbc::Moments> snd_moments;
+    Vector<int> snd_nmoments(nprocs, 0);
+    for (int iproc = 0; iproc < nprocs; ++iproc) {
+        for (int ibox : rank_boxes[iproc]) {
+            auto n0 = snd_moments.size();
+            gather_interactions(tba[ibox], snd_moments);
+            snd_counts.push_back(static_cast<int>(snd_moments.size()-n0));
+            snd_nmoments[iproc] += snd_counts.back();
+        }
+    }
+
+    const int nlocal = static_cast<int>(rank_boxes[myproc].size());
+    Vector<int> box_offset(nlocal+1, 0);
+    Vector<openbc::Moments> box_moments;
+
+#ifdef AMREX_USE_MPI
+    if (nprocs > 1)
+    {
+        MPI_Comm comm = ParallelContext::CommunicatorSub();
+
+        Vector<int> snd_nboxes(nprocs), snd_displ(nprocs), rcv_nboxes(nprocs, nlocal),
+            rcv_displ(nprocs);
+        for (int iproc = 0, offset = 0; iproc < nprocs; ++iproc) {
+            snd_nboxes[iproc] = static_cast<int>(rank_boxes[iproc].size());
+            snd_displ[iproc] = offset;
+            offset += snd_nboxes[iproc];
+            rcv_displ[iproc] = iproc*nlocal;
+        }
+        Vector<int> rcv_counts(nprocs*nlocal);
+        MPI_Alltoallv(snd_counts.data(), snd_nboxes.data(), snd_displ.data(), MPI_INT,
+                      rcv_counts.data(), rcv_nboxes.data(), rcv_displ.data(), MPI_INT, comm);
+
+        constexpr auto nbytes = static_cast<Long>(sizeof(openbc::Moments));
+        Vector<int> snd_bytes(nprocs), snd_bdispl(nprocs), rcv_bytes(nprocs), rcv_bdispl(nprocs);
+        Long snd_tot = 0, rcv_tot = 0;
+        for (int iproc = 0; iproc < nprocs; ++iproc) {
+            Long nrcv = 0;
+            for (int lb = 0; lb < nlocal; ++lb) {
+                nrcv += rcv_counts[iproc*nlocal+lb];
+            }
+            snd_bytes[iproc] = static_cast<int>(snd_nmoments[iproc]*nbytes);
+            rcv_bytes[iproc] = static_cast<int>(nrcv*nbytes);
+            snd_bdispl[iproc] = static_cast<int>(snd_tot);
+            rcv_bdispl[iproc] = static_cast<int>(rcv_tot);
+            snd_tot += snd_nmoments[iproc]*nbytes;
+            rcv_tot += nrcv*nbytes;
+        }
+
+        if (snd_tot > static_cast<Long>(std::numeric_limits<int>::max()) ||
+            rcv_tot > static_cast<Long>(std::numeric_limits<int>::max())) {
+            amrex::Abort("OpenBC: integer overflow. Let us know and we will fix this.");
+        }
+
+        Vector<openbc::Moments> rcv_moments(rcv_tot/nbytes);
+        MPI_Alltoallv(snd_moments.data(), snd_bytes.data(), snd_bdispl.data(), MPI_CHAR,
+                      rcv_moments.data(), rcv_bytes.data(), rcv_bdispl.data(), MPI_CHAR, comm);
+
+        // The received moments are grouped by sender. Regroup them by box.
+        for (int iproc = 0; iproc < nprocs; ++iproc) {
+            for (int lb = 0; lb < nlocal; ++lb) {
+                box_offset[lb+1] += rcv_counts[iproc*nlocal+lb];
+            }
+        }
+        for (int lb = 0; lb < nlocal; ++lb) {
+            box_offset[lb+1] += box_offset[lb];
+        }
+        box_moments.resize(box_offset[nlocal]);
+        Vector<int> pos(box_offset.begin(), box_offset.end()-1);
+        auto it = rcv_moments.cbegin();
+        for (int iproc = 0; iproc < nprocs; ++iproc) {
+            for (int lb = 0; lb < nlocal; ++lb) {
+                const int n = rcv_counts[iproc*nlocal+lb];
+                std::copy(it, it+n, box_moments.begin()+pos[lb]);
+                pos[lb] += n;
+                it += n;
+            }
+        }
+    }
+    else
+#endif
+    {
+        for (int lb = 0; lb < nlocal; ++lb) {
+            box_offset[lb+1] = box_offset[lb] + snd_counts[lb];
+        }
+        box_moments = std::move(snd_moments);
+    }
+
+#ifdef AMREX_USE_GPU
+    Gpu::DeviceVector<openbc::Moments> d_box_moments(box_moments.size());
+    Gpu::copyAsync(Gpu::hostToDevice, box_moments.begin(), box_moments.end(),
+                   d_box_moments.begin());
+    openbc::Moments const* pmom_all = d_box_moments.data();
+#else
+    openbc::Moments const* pmom_all = box_moments.data();
+#endif
+
     auto const problo = m_geom[0].ProbLoArray();
     auto const dx     = m_geom[0].CellSizeArray();
 
     int crse_ratio = m_coarsen_ratio;
-    int nblocks = m_nblocks;
-    openbc::Moments const* pmom = moments.data();
     for (MFIter mfi(m_crse_grown_faces_phi); mfi.isValid(); ++mfi) {
+        const int lb = mfi.LocalIndex();
+        AMREX_ASSERT(rank_boxes[myproc][lb] == mfi.index());
+        int nblocks = box_offset[lb+1] - box_offset[lb];
+        openbc::Moments const* pmom = pmom_all + box_offset[lb];
         Box const& b = mfi.validbox();
         Array4<Real> const& phi_arr = m_crse_grown_faces_phi.array(mfi);
 #if defined(AMREX_USE_GPU)
@@ -783,6 +1006,8 @@ void OpenBCSolver::compute_potential (Gpu::DeviceVector<openbc::Moments> const&
 #endif
     }
 
+    Gpu::streamSynchronize(); // because of d_box_moments
+
     m_phind.ParallelCopy(m_crse_grown_faces_phi, 0, 0, 1, IntVect(0),
                          m_phind.nGrowVect());
 }
@@ -274,6 +274,26 @@ int ParticleContainerBase::AggregationBuffer ()
     return aggregation_buffer;
 }
 
+const std::string& ParticleContainerBase::DepositionType ()
+{
+    static std::string deposition_type;
+    static bool first = true;
+
+    if (first)
+    {
+        first = false;
+        deposition_type = "Tile";
+        ParmParse pp("particles");
+        pp.queryAdd("deposition_type", deposition_type);
+        if (!(deposition_type == "Tile" || deposition_type == "Thread"))
+        {
+            amrex::Abort("particles.deposition_type not implemented.");
+        }
+    }
+
+    return deposition_type;
+}
+
 void ParticleContainerBase::BuildRedistributeMask (int lev, int nghost) const
 {
     BL_PROFILE("ParticleContainer::BuildRedistributeMask");
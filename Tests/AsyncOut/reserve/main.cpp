@@ -0,0 +1,114 @@
+#include <AMReX.H>
+#include <AMReX_AsyncOut.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace amrex;
+
+// Check the back-pressure of amrex.async_out_max_bytes.  A job that blocks
+// the background thread keeps the first write from finishing, so that a
+// second write, which does not fit within the limit, must wait in
+// AsyncOut::Reserve until the first one has released its staging memory.
+
+namespace {
+    constexpr int n_cell = 32;
+    // Room for one of the single-component MultiFabs below on one process,
+    // but not for two
+    constexpr Long max_bytes = Long(3)*n_cell*n_cell*n_cell*Long(sizeof(Real))/2;
+
+    Long staged_bytes (MultiFab const& mf)
+    {
+        Long nbytes = 0;
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            nbytes += mfi.fabbox().numPts() * mf.nComp() * static_cast<Long>(sizeof(Real));
+        }
+        return nbytes;
+    }
+
+    void check (MultiFab const& mf, std::string const& name)
+    {
+        MultiFab mf2(mf.boxArray(), mf.DistributionMap(), mf.nComp(), mf.nGrowVect());
+        VisMF::Read(mf2, name);
+        MultiFab::Subtract(mf2, mf, 0, 0, mf.nComp(), 0);
+        AMREX_ALWAYS_ASSERT(mf2.norm0(0, mf.nComp(), IntVect(0)) == Real(0.0));
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv,true,MPI_COMM_WORLD,[] ()
+    {
+        ParmParse pp("amrex");
+        pp.add("async_out", 1);
+        pp.add("async_out_max_bytes", max_bytes);
+    });
+    {
+        AMREX_ALWAYS_ASSERT(AsyncOut::UseAsyncOut());
+
+        BoxArray ba(Box(IntVect(0), IntVect(n_cell-1)));
+        ba.maxSize(16);
+        DistributionMapping dm(ba);
+
+        MultiFab mf1(ba, dm, 1, 0);
+        MultiFab mf2(ba, dm, 1, 0);
+        mf1.setVal(1.0);
+        mf2.setVal(2.0);
+
+        UtilCreateCleanDirectory("asyncdata", true);
+
+        std::promise<void> gate;
+        std::shared_future<void> gate_future(gate.get_future());
+        AsyncOut::Submit([=] () { gate_future.wait(); });
+
+        // Nothing is reserved yet, so this returns at once, but its job is
+        // queued behind the blocking job.
+        VisMF::AsyncWrite(mf1, "asyncdata/mf1");
+
+        // Open the gate after a while, from another thread
+        std::atomic<bool> gate_opened{false};
+        std::thread opener([&] ()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            gate_opened = true;
+            gate.set_value();
+        });
+
+        // On more than one process, the data may fit within the limit.
+        const bool must_wait = 2*staged_bytes(mf1) > max_bytes;
+
+        // The first write holds its staging memory until its job has run,
+        // so this blocks until the gate opens.
+        VisMF::AsyncWrite(mf2, "asyncdata/mf2");
+        const bool returned_after_gate = gate_opened;
+
+        opener.join();
+
+        amrex::AllPrint() << "Proc. " << ParallelDescriptor::MyProc() << ": staged "
+                          << staged_bytes(mf1) << " bytes per write, second write "
+                          << (returned_after_gate ? "waited" : "did not wait") << "\n";
+        if (must_wait) {
+            AMREX_ALWAYS_ASSERT(returned_after_gate);
+        }
+
+        // A write larger than the limit proceeds when nothing is reserved.
+        AsyncOut::Finish();
+        MultiFab mf3(ba, dm, 2, 0);
+        mf3.setVal(3.0);
+        VisMF::AsyncWrite(mf3, "asyncdata/mf3");
+        AsyncOut::Finish();
+
+        check(mf1, "asyncdata/mf1");
+        check(mf2, "asyncdata/mf2");
+        check(mf3, "asyncdata/mf3");
+
+        amrex::Print() << "AsyncOut reserve test passed\n";
+    }
+    amrex::Finalize();
+}
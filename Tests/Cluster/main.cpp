@@ -0,0 +1,123 @@
+#include <AMReX.H>
+#include <AMReX_Cluster.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+#include <AMReX_TagBox.H>
+
+using namespace amrex;
+
+void test_cluster ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test_cluster();
+    amrex::Finalize();
+}
+
+namespace {
+    BoxList serial_cluster (TagBoxArray const& tags, Real eff, bool use_new_chop, BoxArray domba)
+    {
+        Gpu::PinnedVector<IntVect> tagvec;
+        tags.collate(tagvec);
+        BoxList bl;
+        if (ParallelDescriptor::IOProcessor() && !tagvec.empty()) {
+            ClusterList clist(tagvec.data(), static_cast<Long>(tagvec.size()));
+            if (use_new_chop) {
+                clist.new_chop(eff);
+            } else {
+                clist.chop(eff);
+            }
+            clist.intersect(domba);
+            clist.boxList(bl);
+        }
+        bl.Bcast();
+        return bl;
+    }
+
+    BoxList parallel_cluster (TagBoxArray const& tags, Real eff, bool use_new_chop, BoxArray domba)
+    {
+        Gpu::PinnedVector<IntVect> tagvec;
+        tags.local_collate(tagvec);
+        return ParallelCluster(tagvec.data(), static_cast<Long>(tagvec.size()),
+                               eff, use_new_chop, domba);
+    }
+}
+
+void test_cluster ()
+{
+    int n_cell = 64;
+    int max_grid_size = 16;
+    int nblobs = 6;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nblobs", nblobs);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    // Spherical shells of random centers and radii plus some scattered tags.
+    Vector<Real> blobs;
+    if (ParallelDescriptor::IOProcessor()) {
+        for (int i = 0; i < nblobs; ++i) {
+            for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+                blobs.push_back(amrex::Random()*n_cell);
+            }
+            blobs.push_back(Real(2.0) + amrex::Random()*Real(n_cell)/Real(6.0));
+        }
+    }
+    blobs.resize(nblobs*(AMREX_SPACEDIM+1));
+    ParallelDescriptor::Bcast(blobs.data(), blobs.size());
+
+    Gpu::DeviceVector<Real> d_blobs(blobs.size());
+    Gpu::copyAsync(Gpu::hostToDevice, blobs.begin(), blobs.end(), d_blobs.begin());
+    Real const* pblobs = d_blobs.data();
+
+    TagBoxArray tags(ba, dm);
+    tags.setVal(TagBox::CLEAR);
+    for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+        auto const& a = tags.array(mfi);
+        amrex::ParallelForRNG(mfi.validbox(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k, RandomEngine const& engine) noexcept
+        {
+            IntVect iv(AMREX_D_DECL(i,j,k));
+            for (int ib = 0; ib < nblobs; ++ib) {
+                Real const* b = pblobs + ib*(AMREX_SPACEDIM+1);
+                Real r2 = 0;
+                for (int n = 0; n < AMREX_SPACEDIM; ++n) {
+                    r2 += (iv[n]-b[n])*(iv[n]-b[n]);
+                }
+                Real r = std::sqrt(r2);
+                if (r <= b[AMREX_SPACEDIM] && r >= Real(0.7)*b[AMREX_SPACEDIM]) {
+                    a(i,j,k) = TagBox::SET;
+                }
+            }
+            if (amrex::Random(engine) < Real(1.e-4)) {
+                a(i,j,k) = TagBox::SET;
+            }
+        });
+    }
+
+    // Leave out a corner of the domain to exercise the intersection.
+    BoxList dombl(domain);
+    dombl.complementIn(domain, BoxList(Box(IntVect(0), IntVect(n_cell/4-1))));
+    BoxArray domba(dombl);
+
+    for (bool use_new_chop : {false, true}) {
+        for (Real eff : {Real(0.5), Real(0.7), Real(0.9)}) {
+            BoxList bl_s = serial_cluster(tags, eff, use_new_chop, domba);
+            BoxList bl_p = parallel_cluster(tags, eff, use_new_chop, domba);
+            amrex::Print() << "use_new_chop = " << use_new_chop << ", eff = " << eff
+                           << ": " << bl_s.size() << " serial and "
+                           << bl_p.size() << " parallel boxes\n";
+            AMREX_ALWAYS_ASSERT(bl_s.size() == bl_p.size());
+            AMREX_ALWAYS_ASSERT(std::equal(bl_s.begin(), bl_s.end(), bl_p.begin()));
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#include <AMReX.H>
+#include <AMReX_EB2_IndexSpace_STL.H>
+#include <AMReX_EB_STL_utils.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <fstream>
+#include <iomanip>
+
+using namespace amrex;
+
+// Build the same STL geometry with the bounding volume hierarchy and with
+// the brute-force loop over all triangles (eb2.stl_use_bvh = 0), and check
+// that the level set and all the EB data are bit-for-bit identical.
+
+namespace {
+
+// Write a bumpy sphere as an ASCII STL file.  The triangles are oriented so
+// that their normals point outwards.
+void write_stl (std::string const& fname, int nth, int nph)
+{
+    if (!ParallelDescriptor::IOProcessor()) { return; }
+
+    const Real c[] = {0.5_rt, 0.5_rt, 0.5_rt};
+    auto vertex = [&] (int i, int j) -> Array<Real,3>
+    {
+        const Real th = Math::pi<Real>() * Real(i) / Real(nth);
+        const Real ph = Real(2.0) * Math::pi<Real>() * Real(j % nph) / Real(nph);
+        const Real r = Real(0.3) * (Real(1.0) + Real(0.1)*std::sin(Real(5.0)*th)*std::cos(Real(3.0)*ph));
+        return {c[0] + r*std::sin(th)*std::cos(ph),
+                c[1] + r*std::sin(th)*std::sin(ph),
+                c[2] + r*std::cos(th)};
+    };
+
+    std::ofstream ofs(fname);
+    ofs << std::setprecision(17);
+    ofs << "solid bumpy\n";
+    auto facet = [&] (Array<Real,3> v1, Array<Real,3> v2, Array<Real,3> v3)
+    {
+        const Real n[] = {(v2[1]-v1[1])*(v3[2]-v1[2]) - (v2[2]-v1[2])*(v3[1]-v1[1]),
+                          (v2[2]-v1[2])*(v3[0]-v1[0]) - (v2[0]-v1[0])*(v3[2]-v1[2]),
+                          (v2[0]-v1[0])*(v3[1]-v1[1]) - (v2[1]-v1[1])*(v3[0]-v1[0])};
+        Real outward = 0;
+        for (int d = 0; d < 3; ++d) {
+            outward += n[d] * ((v1[d]+v2[d]+v3[d])/Real(3.0) - c[d]);
+        }
+        if (outward < 0) { std::swap(v1, v2); }
+        ofs << "  facet normal 0 0 0\n"
+            << "    outer loop\n";
+        for (auto const& v : {v1, v2, v3}) {
+            ofs << "      vertex " << v[0] << " " << v[1] << " " << v[2] << "\n";
+        }
+        ofs << "    endloop\n"
+            << "  endfacet\n";
+    };
+    for (int i = 0; i < nth; ++i) {
+        for (int j = 0; j < nph; ++j) {
+            if (i > 0) {
+                facet(vertex(i,j), vertex(i+1,j), vertex(i,j+1));
+            }
+            if (i < nth-1) {
+                facet(vertex(i+1,j), vertex(i+1,j+1), vertex(i,j+1));
+            }
+        }
+    }
+    ofs << "endsolid bumpy\n";
+}
+
+// A MultiCutFab only has data in the boxes with cut cells
+template <typename MF>
+bool has_data (MF const&, MFIter const&) { return true; }
+
+bool has_data (MultiCutFab const& mf, MFIter const& mfi) { return mf.ok(mfi); }
+
+// Number of values that differ between a and b
+template <typename MF>
+Long num_diff (MF const& a, MF const& b, int ncomp)
+{
+    ReduceOps<ReduceOpSum> reduce_op;
+    ReduceData<Long> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    Long r = 0;
+    for (MFIter mfi(a.boxArray(), a.DistributionMap()); mfi.isValid(); ++mfi)
+    {
+        if (has_data(a, mfi) != has_data(b, mfi)) {
+            ++r;
+        } else if (has_data(a, mfi)) {
+            auto const& aa = a.const_array(mfi);
+            auto const& ba = b.const_array(mfi);
+            reduce_op.eval(a[mfi].box(), ncomp, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) -> ReduceTuple
+            {
+                return {(aa(i,j,k,n) != ba(i,j,k,n)) ? 1 : 0};
+            });
+        }
+    }
+    r += amrex::get<0>(reduce_data.value(reduce_op));
+    ParallelDescriptor::ReduceLongSum(r);
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int nth = 48;
+        int nph = 96;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nth", nth);
+            pp.query("nph", nph);
+        }
+
+        const std::string stl_file("bumpy_sphere.stl");
+        write_stl(stl_file, nth, nph);
+        ParallelDescriptor::Barrier();
+
+        Geometry geom(Box(IntVect(0), IntVect(n_cell-1)),
+                      RealBox({0.,0.,0.}, {1.,1.,1.}),
+                      CoordSys::cartesian, {0,0,0});
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        STLtools stl_bvh;
+        stl_bvh.read_stl_file(stl_file, 1.0_rt, {0.,0.,0.}, 0);
+        STLtools stl_brute;
+        stl_brute.setBVHOptimization(false);
+        stl_brute.read_stl_file(stl_file, 1.0_rt, {0.,0.,0.}, 0);
+
+        // Level set at the nodes
+        const IntVect ng(2);
+        MultiFab ls_bvh(amrex::convert(ba, IntVect(1)), dm, 1, ng);
+        MultiFab ls_brute(amrex::convert(ba, IntVect(1)), dm, 1, ng);
+        stl_bvh.fill(ls_bvh, ng, geom);
+        stl_brute.fill(ls_brute, ng, geom);
+        const Long nd_ls = num_diff(ls_bvh, ls_brute, 1);
+        amrex::Print() << "Level set values that differ: " << nd_ls << "\n";
+        AMREX_ALWAYS_ASSERT(nd_ls == 0);
+
+        // The tree only tells whether a triangle touches the box, so it may
+        // report cut boxes that the node sampling finds regular or covered,
+        // but never the other way around.
+        for (int mgs : {4, 8, 16}) {
+            BoxArray bba(geom.Domain());
+            bba.maxSize(mgs);
+            for (int i = 0; i < static_cast<int>(bba.size()); ++i) {
+                const Box bx = amrex::surroundingNodes(bba[i]);
+                const int t_bvh = stl_bvh.getBoxType(bx, geom, RunOn::Gpu);
+                const int t_brute = stl_brute.getBoxType(bx, geom, RunOn::Gpu);
+                AMREX_ALWAYS_ASSERT(t_bvh == t_brute || t_bvh == STLtools::mixedcells);
+            }
+        }
+
+        // EB data on all the levels.  The coarse levels are required, so
+        // those that cannot be coarsened from the finer level are built
+        // from the STL geometry too.
+        const int max_coarsening_level = 2;
+        auto make_index_space = [&] (bool bvh)
+        {
+            return std::make_unique<EB2::IndexSpaceSTL>
+                (stl_file, 1.0_rt, Array<Real,3>{0.,0.,0.}, 0, geom,
+                 max_coarsening_level, max_coarsening_level, 4, false,
+                 EB2::ExtendDomainFace(), max_coarsening_level, bvh);
+        };
+        auto is_bvh = make_index_space(true);
+        auto is_brute = make_index_space(false);
+
+        Long nd_eb = 0;
+        for (int ilev = 0; ilev <= max_coarsening_level; ++ilev)
+        {
+            const Geometry cgeom = amrex::coarsen(geom, 1 << ilev);
+            const BoxArray cba = amrex::coarsen(ba, 1 << ilev);
+            const Vector<int> ngrow{2,2,2};
+            auto fact_bvh = makeEBFabFactory(is_bvh.get(), cgeom, cba, dm, ngrow, EBSupport::full);
+            auto fact_brute = makeEBFabFactory(is_brute.get(), cgeom, cba, dm, ngrow, EBSupport::full);
+
+            Long nd = num_diff(fact_bvh->getMultiEBCellFlagFab(),
+                               fact_brute->getMultiEBCellFlagFab(), 1);
+            nd += num_diff(fact_bvh->getVolFrac(), fact_brute->getVolFrac(), 1);
+            nd += num_diff(fact_bvh->getCentroid(), fact_brute->getCentroid(), 3);
+            nd += num_diff(fact_bvh->getBndryCent(), fact_brute->getBndryCent(), 3);
+            nd += num_diff(fact_bvh->getBndryNormal(), fact_brute->getBndryNormal(), 3);
+            nd += num_diff(fact_bvh->getBndryArea(), fact_brute->getBndryArea(), 1);
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                nd += num_diff(*fact_bvh->getAreaFrac()[idim], *fact_brute->getAreaFrac()[idim], 1);
+                nd += num_diff(*fact_bvh->getFaceCent()[idim], *fact_brute->getFaceCent()[idim], 2);
+            }
+
+            amrex::Print() << "Level " << ilev << ": EB values that differ: " << nd << "\n";
+            nd_eb += nd;
+        }
+        AMREX_ALWAYS_ASSERT(nd_eb == 0);
+    }
+    amrex::Finalize();
+}
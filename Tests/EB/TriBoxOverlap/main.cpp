@@ -0,0 +1,115 @@
+#include <AMReX.H>
+#include <AMReX_EB_triGeomOps_K.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+// Unit tests of the triangle-box overlap test used by the STL bounding
+// volume hierarchy.  Each case is run with the box [-1,1]^3 and with the
+// same configuration shifted and stretched, so that the center and the half
+// widths are not trivial.  All the coordinates are exact binary fractions.
+
+namespace {
+
+int check (char const* name, Real const (&t)[3][3], bool expected)
+{
+    int nfail = 0;
+    const Real shift[] = {0.25_rt, -0.5_rt, 2.0_rt};
+    const Real scale[] = {1.0_rt, 2.0_rt, 0.5_rt};
+    for (int itry = 0; itry < 2; ++itry)
+    {
+        Real c[3], h[3], t1[3], t2[3], t3[3];
+        for (int d = 0; d < 3; ++d) {
+            const Real s = (itry == 0) ? 1.0_rt : scale[d];
+            const Real o = (itry == 0) ? 0.0_rt : shift[d];
+            c[d] = o;
+            h[d] = s;
+            t1[d] = o + s*t[0][d];
+            t2[d] = o + s*t[1][d];
+            t3[d] = o + s*t[2][d];
+        }
+        // The answer must not depend on the order of the vertices.
+        const bool r = tri_geom_ops::tri_box_overlaps(t1,t2,t3,c,h);
+        const bool r2 = tri_geom_ops::tri_box_overlaps(t2,t3,t1,c,h);
+        const bool r3 = tri_geom_ops::tri_box_overlaps(t3,t2,t1,c,h);
+        if (r != expected || r2 != expected || r3 != expected) {
+            amrex::Print() << "FAIL: " << name << (itry == 0 ? "" : " (shifted)")
+                           << ": expected " << expected << "\n";
+            ++nfail;
+        }
+    }
+    return nfail;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int nfail = 0;
+
+        // All the vertices are beyond the x = 1 face.
+        nfail += check("separated along a face normal",
+                       {{1.5_rt, 0.0_rt, 0.0_rt},
+                        {2.0_rt, 1.0_rt, 0.0_rt},
+                        {2.0_rt, 0.0_rt, 1.0_rt}}, false);
+
+        // The plane x+y+z = 3.5 misses the corner (1,1,1), but the
+        // triangle spans the box in every direction.
+        nfail += check("separated along the triangle normal",
+                       {{3.5_rt, 0.0_rt, 0.0_rt},
+                        {0.0_rt, 3.5_rt, 0.0_rt},
+                        {0.0_rt, 0.0_rt, 3.5_rt}}, false);
+
+        // The triangle passes by the z-edge at x = y = 1.  Neither the
+        // faces of the box nor the plane of the triangle separate them, but
+        // the cross product of the edge from (2,0.5,0) to (0.5,2,0) with
+        // the z axis does.
+        nfail += check("separated along an edge cross product",
+                       {{2.0_rt, 0.5_rt, 0.0_rt},
+                        {0.5_rt, 2.0_rt, 0.0_rt},
+                        {1.5_rt, 1.5_rt, 0.5_rt}}, false);
+
+        // An edge of the triangle passes through the box, and a vertex
+        // lies on the z-edge.
+        nfail += check("cutting an edge",
+                       {{1.5_rt, 0.0_rt, 0.0_rt},
+                        {0.0_rt, 1.5_rt, 0.0_rt},
+                        {1.0_rt, 1.0_rt, 0.5_rt}}, true);
+
+        // A vertex on the x = 1 face
+        nfail += check("touching a face",
+                       {{1.0_rt, 0.0_rt, 0.0_rt},
+                        {2.0_rt, 1.0_rt, 0.0_rt},
+                        {2.0_rt, 0.0_rt, 1.0_rt}}, true);
+
+        // A vertex at the corner (1,1,1)
+        nfail += check("touching a corner",
+                       {{1.0_rt, 1.0_rt, 1.0_rt},
+                        {2.0_rt, 1.5_rt, 1.0_rt},
+                        {1.5_rt, 2.0_rt, 3.0_rt}}, true);
+
+        // An edge lying in the x = 1 face
+        nfail += check("edge in a face",
+                       {{1.0_rt, -2.0_rt, 0.0_rt},
+                        {1.0_rt,  2.0_rt, 0.0_rt},
+                        {3.0_rt,  0.0_rt, 0.0_rt}}, true);
+
+        nfail += check("triangle inside the box",
+                       {{-0.5_rt, -0.5_rt, -0.5_rt},
+                        { 0.5_rt, -0.25_rt, 0.0_rt},
+                        { 0.0_rt,  0.5_rt,  0.25_rt}}, true);
+
+        // The triangle cuts through the box with all the vertices far
+        // outside.
+        nfail += check("box inside the triangle",
+                       {{-8.0_rt, -8.0_rt, 0.0_rt},
+                        { 8.0_rt, -8.0_rt, 0.0_rt},
+                        { 0.0_rt,  8.0_rt, 0.0_rt}}, true);
+
+        AMREX_ALWAYS_ASSERT(nfail == 0);
+        amrex::Print() << "All triangle-box overlap tests passed\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,141 @@
+#include <AMReX.H>
+#include <AMReX_FFT.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParmParse.H>
+
+#include <limits>
+
+using namespace amrex;
+
+namespace {
+
+// Compare the spectral data of r2c with a direct DFT of x
+Real check_dft (FFT::R2C<Real>& r2c, MultiFab const& x, Box const& domain)
+{
+    const int ncomp = x.nComp();
+
+    // Copy x to all processes
+    MultiFab gmf(BoxArray(domain), DistributionMapping(Vector<int>{0}), ncomp, 0);
+    gmf.ParallelCopy(x);
+    FArrayBox full(domain, ncomp, The_Pinned_Arena());
+    if (ParallelDescriptor::MyProc() == 0) {
+        full.copy<RunOn::Host>(gmf[0]);
+    }
+    ParallelDescriptor::Bcast(full.dataPtr(), full.size(), 0);
+    auto const& xa = full.const_array();
+
+    const IntVect len = domain.length();
+    const IntVect lo = domain.smallEnd();
+    Real err = 0.0;
+    Real xmax = 0.0;
+    auto& spmf = r2c.spectralData();
+    for (MFIter mfi(spmf); mfi.isValid(); ++mfi) {
+        auto const& sa = spmf.const_array(mfi);
+        for (int n = 0; n < ncomp; ++n) {
+            amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k)
+            {
+                IntVect kv(AMREX_D_DECL(i,j,k));
+                GpuComplex<Real> sum(0.0);
+                amrex::LoopOnCpu(domain, [&] (int ii, int jj, int kk)
+                {
+                    IntVect tv = IntVect(AMREX_D_DECL(ii,jj,kk)) - lo;
+                    Real phase = 0.0;
+                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                        phase += Real(kv[idim]*tv[idim] % len[idim]) / Real(len[idim]);
+                    }
+                    phase *= -2.0*Math::pi<Real>();
+                    sum += xa(ii,jj,kk,n) * GpuComplex<Real>(std::cos(phase), std::sin(phase));
+                });
+                err = std::max(err, amrex::abs(sum - sa(i,j,k,n)));
+                xmax = std::max(xmax, amrex::abs(sum));
+            });
+        }
+    }
+    ParallelDescriptor::ReduceRealMax(err);
+    ParallelDescriptor::ReduceRealMax(xmax);
+    return err/xmax;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        constexpr Real eps = std::numeric_limits<Real>::epsilon();
+
+        // Lengths with radices 4, 3, 5, 2 and a prime computed by Bluestein's algorithm
+        Box domain(IntVect(AMREX_D_DECL(-3,0,2)), IntVect(AMREX_D_DECL(8,9,18)));
+        {
+            const int ncomp = 2;
+            BoxArray ba(domain);
+            ba.maxSize(IntVect(AMREX_D_DECL(5,4,6)));
+            DistributionMapping dm(ba);
+            MultiFab x(ba, dm, ncomp, 1);
+            MultiFab y(ba, dm, ncomp, 0);
+            FillRandom(x, 0, ncomp);
+
+            FFT::R2C<Real> r2c(domain, ncomp);
+            r2c.forward(x);
+            Real err = check_dft(r2c, x, domain);
+            amrex::Print() << "Relative difference from a direct DFT: " << err << '\n';
+            AMREX_ALWAYS_ASSERT(err < 100*eps);
+
+            r2c.backward(y);
+            y.mult(r2c.scalingFactor());
+            MultiFab::Subtract(y, x, 0, 0, ncomp, 0);
+            err = y.norminf(0, ncomp, IntVect(0));
+            amrex::Print() << "Error of forward and backward: " << err << '\n';
+            AMREX_ALWAYS_ASSERT(err < 100*eps);
+        }
+
+        {
+            int n_cell = 64;
+            int max_grid_size = 24;
+            {
+                ParmParse pp;
+                pp.query("n_cell", n_cell);
+                pp.query("max_grid_size", max_grid_size);
+            }
+            Geometry geom(Box(IntVect(0),IntVect(n_cell-1)),
+                          RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                          0, {AMREX_D_DECL(1,1,1)});
+            BoxArray ba(geom.Domain());
+            ba.maxSize(max_grid_size);
+            DistributionMapping dm(ba);
+
+            MultiFab rhs(ba, dm, 1, 0);
+            MultiFab soln(ba, dm, 1, 1);
+            FillRandom(rhs, 0, 1);
+            rhs.plus(-rhs.sum(0)/Real(geom.Domain().numPts()), 0, 1);
+
+            FFT::Poisson<MultiFab> poisson(geom);
+            poisson.solve(soln, rhs);
+
+            // Residual of the discrete Laplacian
+            soln.FillBoundary(geom.periodicity());
+            const auto dxinv = geom.InvCellSizeArray();
+            auto const& sa = soln.const_arrays();
+            auto const& ra = rhs.arrays();
+            ParallelFor(rhs, [=] AMREX_GPU_DEVICE (int b, int i, int j, int k) noexcept
+            {
+                auto const& s = sa[b];
+                ra[b](i,j,k) -= AMREX_D_TERM(
+                    (s(i-1,j,k) - 2.*s(i,j,k) + s(i+1,j,k)) * dxinv[0]*dxinv[0],
+                  + (s(i,j-1,k) - 2.*s(i,j,k) + s(i,j+1,k)) * dxinv[1]*dxinv[1],
+                  + (s(i,j,k-1) - 2.*s(i,j,k) + s(i,j,k+1)) * dxinv[2]*dxinv[2]);
+            });
+            Real resid = rhs.norminf(0, 1, IntVect(0));
+            amrex::Print() << "Max residual of the Poisson solve: " << resid << '\n';
+            // Roundoff of the discrete Laplacian of soln
+            Real scale = 0.0;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                scale += 4.0*dxinv[idim]*dxinv[idim];
+            }
+            scale *= soln.norminf(0, 1, IntVect(0));
+            AMREX_ALWAYS_ASSERT(resid < 100*eps*scale);
+        }
+    }
+    amrex::Finalize();
+}
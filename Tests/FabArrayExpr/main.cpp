@@ -0,0 +1,79 @@
+#include <AMReX.H>
+#include <AMReX_FabArrayExpr.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_iMultiFab.H>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        Box domain(IntVect(0),IntVect(63));
+        BoxArray ba(domain);
+        ba.maxSize(16);
+        DistributionMapping dm(ba);
+
+        const int ncomp = 3;
+        const IntVect ng(1);
+        MultiFab a(ba,dm,ncomp,ng), b(ba,dm,ncomp,ng), c(ba,dm,ncomp,ng), d(ba,dm,ncomp,ng);
+        MultiFab ref(ba,dm,ncomp,ng);
+        FillRandom(b, 0, ncomp);
+        FillRandom(c, 0, ncomp);
+        FillRandom(d, 0, ncomp);
+        for (int n = 0; n < ncomp; ++n) {
+            b.plus(Real(1.0), n, 1, ng.max()); // keep it away from zero for division
+        }
+        const Real dt = Real(0.1);
+        const Real tol = std::numeric_limits<Real>::epsilon() * Real(100.);
+
+        // a = b + dt*(c - d)
+        {
+            a.setVal(0.0);
+            Evaluate(a, 0, b + dt*(c - d), ncomp, ng);
+            MultiFab::LinComb(ref, Real(1.0), c, 0, Real(-1.0), d, 0, 0, ncomp, ng);
+            MultiFab::Xpay(ref, dt, b, 0, 0, ncomp, ng);
+            MultiFab::Subtract(ref, a, 0, 0, ncomp, ng);
+            AMREX_ALWAYS_ASSERT(ref.norminf(0, ncomp, ng) < tol);
+        }
+
+        // a = -(c*d)/b + 2, with the destination on the right-hand side
+        {
+            MultiFab::Copy(a, c, 0, 0, ncomp, ng);
+            Evaluate(a, -(a*d)/b + 2);
+            MultiFab::Copy(ref, c, 0, 0, ncomp, 0);
+            MultiFab::Multiply(ref, d, 0, 0, ncomp, 0);
+            MultiFab::Divide(ref, b, 0, 0, ncomp, 0);
+            ref.mult(Real(-1.0), 0, ncomp);
+            ref.plus(Real(2.0), 0, ncomp);
+            MultiFab::Subtract(ref, a, 0, 0, ncomp, 0);
+            AMREX_ALWAYS_ASSERT(ref.norminf(0, ncomp, IntVect(0)) < tol);
+        }
+
+        // a = c - d and |a|^2 in one pass, and a dot product on one component
+        {
+            Real r2 = EvaluateSum(a, 0, c - d, ExprResult{}*ExprResult{}, ncomp, IntVect(0));
+            MultiFab::LinComb(ref, Real(1.0), c, 0, Real(-1.0), d, 0, 0, ncomp, 0);
+            Real r2_ref = MultiFab::Dot(ref, 0, ref, 0, ncomp, 0);
+            AMREX_ALWAYS_ASSERT(std::abs(r2-r2_ref) < tol*r2_ref);
+
+            Real cd = EvaluateSum(makeExpr(c,1)*makeExpr(d,2), 1, IntVect(0));
+            Real cd_ref = MultiFab::Dot(c, 1, d, 2, 1, 0);
+            AMREX_ALWAYS_ASSERT(std::abs(cd-cd_ref) < tol*cd_ref);
+        }
+
+        // iMultiFab
+        {
+            iMultiFab ia(ba,dm,1,0), ib(ba,dm,1,0);
+            ib.setVal(3);
+            Evaluate(ia, 2*ib - 1);
+            AMREX_ALWAYS_ASSERT(ia.min(0) == 5 && ia.max(0) == 5);
+            auto s = EvaluateSum(ia, 0, ia + ib, ExprResult{}, 1, IntVect(0));
+            AMREX_ALWAYS_ASSERT(s == 8*domain.numPts());
+        }
+
+        amrex::Print() << "FabArrayExpr test passed.\n";
+    }
+    amrex::Finalize();
+}
@@ -101,65 +101,109 @@ main (int argc, char* argv[])
         }
     }
 
-    ParallelDescriptor::Barrier();
-
-    Vector<std::unique_ptr<MultiFab> > mfs(nlevels);
-    Vector<BoxArray> bas(nlevels);
-    bas[0] = ba;
-    DistributionMapping dm{ba};
-    mfs[0] = std::make_unique<MultiFab>(ba, dm, 1, 1);
-    mfs[0]->setVal(1.0);
-    for (int lev=1; lev<nlevels; ++lev) {
-        bas[lev] = BoxArray(bas[lev-1]);
-        bas[lev].coarsen(2);
-        mfs[lev] = std::make_unique<MultiFab>(bas[lev], dm, 1, 1);
-        mfs[lev]->setVal(1.0);
-    }
-
-    Vector<Real> points(nlevels);
-    for (int lev=0; lev<nlevels; ++lev) {
-        points[lev] = mfs[lev]->norm1();
-        if (ParallelDescriptor::IOProcessor()) {
-            std::cout << points[lev] << " points on level " << lev << '\n';
-        }
-    }
-
     int nrounds = 1000;
+    std::vector<std::string> strategies{"SFC", "GRAPH"};
     {
         ParmParse pp;
         pp.query("nrounds", nrounds);
+        pp.queryarr("strategies", strategies);
     }
 
-    Real err = 0.0;
+    // Node id of each rank, which is the lowest rank on the node
+    const Vector<int>& rank_to_node = DistributionMapping::RankToNode();
+
+    Vector<std::unique_ptr<MultiFab> > mfs(nlevels);
 
-    ParallelDescriptor::Barrier();
-    auto wt0 = ParallelDescriptor::second();
+    for (auto const& strategy : strategies)
+    {
+        if (strategy == "ROUNDROBIN") {
+            DistributionMapping::strategy(DistributionMapping::ROUNDROBIN);
+        } else if (strategy == "KNAPSACK") {
+            DistributionMapping::strategy(DistributionMapping::KNAPSACK);
+        } else if (strategy == "SFC") {
+            DistributionMapping::strategy(DistributionMapping::SFC);
+        } else if (strategy == "RRSFC") {
+            DistributionMapping::strategy(DistributionMapping::RRSFC);
+        } else if (strategy == "GRAPH") {
+            DistributionMapping::strategy(DistributionMapping::GRAPH);
+        } else {
+            amrex::Abort("Unknown strategy " + strategy);
+        }
 
-    for (int iround = 0; iround < nrounds; ++iround) {
-        for (int c=0; c<2; ++c) {
-            for (int lev = 0; lev < nlevels; ++lev) {
-                mfs[lev]->FillBoundary_nowait();
-                mfs[lev]->FillBoundary_finish();
+        ParallelDescriptor::Barrier();
+
+        Vector<BoxArray> bas(nlevels);
+        bas[0] = ba;
+        DistributionMapping dm{ba};
+        mfs[0] = std::make_unique<MultiFab>(ba, dm, 1, 1);
+        mfs[0]->setVal(1.0);
+        for (int lev=1; lev<nlevels; ++lev) {
+            bas[lev] = BoxArray(bas[lev-1]);
+            bas[lev].coarsen(2);
+            mfs[lev] = std::make_unique<MultiFab>(bas[lev], dm, 1, 1);
+            mfs[lev]->setVal(1.0);
+        }
+
+        // Number of ghost cells on level 0 filled from other ranks and other nodes
+        Long ghost_off_rank = 0, ghost_off_node = 0;
+        {
+            std::vector<std::pair<int,Box> > isects;
+            for (int i = 0; i < ba.size(); ++i) {
+                ba.intersections(amrex::grow(ba[i],1), isects);
+                for (auto const& is : isects) {
+                    const int j = is.first;
+                    if (dm[i] != dm[j]) {
+                        ghost_off_rank += is.second.numPts();
+                        if (rank_to_node[dm[i]] != rank_to_node[dm[j]]) {
+                            ghost_off_node += is.second.numPts();
+                        }
+                    }
+                }
             }
-            for (int lev = nlevels-1; lev >= 0; --lev) {
-                mfs[lev]->FillBoundary_nowait();
-                mfs[lev]->FillBoundary_finish();
+        }
+
+        Vector<Real> points(nlevels);
+        for (int lev=0; lev<nlevels; ++lev) {
+            points[lev] = mfs[lev]->norm1();
+            if (ParallelDescriptor::IOProcessor()) {
+                std::cout << points[lev] << " points on level " << lev << '\n';
             }
         }
-        Real e = double(iround+ParallelDescriptor::MyProc());
-        ParallelDescriptor::ReduceRealMax(e);
-        err += e;
-    }
 
-    ParallelDescriptor::Barrier();
-    auto wt1 = ParallelDescriptor::second();
+        Real err = 0.0;
+
+        ParallelDescriptor::Barrier();
+        auto wt0 = ParallelDescriptor::second();
+
+        for (int iround = 0; iround < nrounds; ++iround) {
+            for (int c=0; c<2; ++c) {
+                for (int lev = 0; lev < nlevels; ++lev) {
+                    mfs[lev]->FillBoundary_nowait();
+                    mfs[lev]->FillBoundary_finish();
+                }
+                for (int lev = nlevels-1; lev >= 0; --lev) {
+                    mfs[lev]->FillBoundary_nowait();
+                    mfs[lev]->FillBoundary_finish();
+                }
+            }
+            Real e = double(iround+ParallelDescriptor::MyProc());
+            ParallelDescriptor::ReduceRealMax(e);
+            err += e;
+        }
+
+        ParallelDescriptor::Barrier();
+        auto wt1 = ParallelDescriptor::second();
 
-    if (ParallelDescriptor::IOProcessor()) {
-        std::cout << "Using MPI" << '\n';
-        std::cout << "----------------------------------------------" << '\n';
-        std::cout << "Fill Boundary Time: " << wt1-wt0 << '\n';
-        std::cout << "----------------------------------------------" << '\n';
-        std::cout << "ignore this line " << err << '\n';
+        if (ParallelDescriptor::IOProcessor()) {
+            std::cout << "Using MPI" << '\n';
+            std::cout << "----------------------------------------------" << '\n';
+            std::cout << "Strategy: " << strategy << '\n';
+            std::cout << "Ghost cells from other ranks: " << ghost_off_rank << '\n';
+            std::cout << "Ghost cells from other nodes: " << ghost_off_node << '\n';
+            std::cout << "Fill Boundary Time: " << wt1-wt0 << '\n';
+            std::cout << "----------------------------------------------" << '\n';
+            std::cout << "ignore this line " << err << '\n';
+        }
     }
 
     //
@@ -0,0 +1,108 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+
+#include <cstdint>
+
+using namespace amrex;
+
+// Fill the ghost cells of several MultiFabs with different BoxArrays,
+// index types, numbers of components and numbers of ghost cells together
+// with fabarray.fb_fuse_messages on, and compare with FillBoundary of
+// each MultiFab.
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 32;
+        int nsteps = 3;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("nsteps", nsteps);
+        }
+
+        Box domain(IntVect(0),IntVect(n_cell-1));
+        Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                      0, {AMREX_D_DECL(1,1,1)});
+
+        struct Case {
+            int max_grid_size;
+            IntVect ixtype;
+            int ncomp;
+            int scomp;  // first component filled
+            int nfill;  // number of components filled
+            IntVect nghost_mf;
+            IntVect nghost;
+            int cross;
+            bool periodic;
+        };
+        Vector<Case> cases{
+            {8,  IntVect(0), 1, 0, 1, IntVect(1), IntVect(1), 0, true},
+            {16, IntVect(0), 3, 0, 3, IntVect(2), IntVect(2), 0, true},
+            {8,  IntVect(1), 2, 0, 2, IntVect(1), IntVect(1), 0, true},
+            {12, IntVect(0), 4, 1, 2, IntVect(2), IntVect(AMREX_D_DECL(2,1,0)), 0, false},
+            {16, IntVect(0), 2, 0, 2, IntVect(2), IntVect(2), 1, true},
+            {8,  IntVect(0), 1, 0, 1, IntVect(1), IntVect(0), 0, true},
+        };
+
+        Vector<MultiFab> mf;
+        Vector<MultiFab> ref;
+        Vector<int> scomp, ncomp, cross;
+        Vector<IntVect> nghost;
+        Vector<Periodicity> period;
+        for (auto const& c : cases) {
+            BoxArray ba(domain);
+            ba.maxSize(c.max_grid_size);
+            ba.convert(c.ixtype);
+            DistributionMapping dm(ba);
+            mf.emplace_back(ba, dm, c.ncomp, c.nghost_mf);
+            ref.emplace_back(ba, dm, c.ncomp, c.nghost_mf);
+            scomp.push_back(c.scomp);
+            ncomp.push_back(c.nfill);
+            nghost.push_back(c.nghost);
+            cross.push_back(c.cross);
+            period.push_back(c.periodic ? geom.periodicity() : Periodicity::NonPeriodic());
+        }
+        const int nmfs = mf.size();
+
+        Real err = 0.0;
+        for (int step = 0; step < nsteps; ++step)
+        {
+            for (int i = 0; i < nmfs; ++i) {
+                // A periodic function of the index, so that the nodes
+                // shared by nodal boxes have the same value in all of them.
+                mf[i].setVal(-1.0);
+                auto const& a = mf[i].arrays();
+                const int nc = n_cell;
+                ParallelFor(mf[i], IntVect(0), mf[i].nComp(),
+                [=] AMREX_GPU_DEVICE (int b, int ii, int jj, int kk, int n) noexcept
+                {
+                    std::uint32_t h = (std::uint32_t(ii%nc)*73856093U)
+                        ^ (std::uint32_t(jj%nc)*19349663U) ^ (std::uint32_t(kk%nc)*83492791U)
+                        ^ (std::uint32_t(n+step)*2654435761U);
+                    h ^= h >> 13;
+                    h *= 0x5bd1e995U;
+                    h ^= h >> 15;
+                    a[b](ii,jj,kk,n) = Real(h & 0xffffU);
+                });
+                MultiFab::Copy(ref[i], mf[i], 0, 0, mf[i].nComp(), mf[i].nGrowVect());
+                ref[i].FillBoundary(scomp[i], ncomp[i], nghost[i], period[i], cross[i]);
+            }
+
+            FabArrayBase::fb_fuse_messages = true;
+            FillBoundary(GetVecOfPtrs(mf), scomp, ncomp, nghost, period, cross);
+            FabArrayBase::fb_fuse_messages = false;
+
+            for (int i = 0; i < nmfs; ++i) {
+                MultiFab::Subtract(mf[i], ref[i], 0, 0, mf[i].nComp(), mf[i].nGrowVect());
+                err = std::max(err, mf[i].norminf(0, mf[i].nComp(), mf[i].nGrowVect()));
+            }
+        }
+
+        amrex::Print() << "Max difference from FillBoundary of each MultiFab: " << err << '\n';
+        AMREX_ALWAYS_ASSERT(err == Real(0.0));
+    }
+    amrex::Finalize();
+}
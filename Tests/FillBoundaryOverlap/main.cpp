@@ -0,0 +1,70 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+
+        Box domain(IntVect(0),IntVect(n_cell-1));
+        Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                      0, {AMREX_D_DECL(1,1,1)});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        MultiFab phi(ba, dm, 1, 2);
+        MultiFab lap(ba, dm, 1, 0);
+        MultiFab lap_ref(ba, dm, 1, 0);
+        phi.setVal(0.0);
+        FillRandom(phi, 0, 1);
+
+        // Fourth-order Laplacian with a stencil width of two
+        auto const& pma = phi.const_arrays();
+        auto stencil = [=] AMREX_GPU_DEVICE (int box_no, int i, int j, int k) noexcept
+        {
+            auto const& p = pma[box_no];
+            Real r = Real(-2.5)*AMREX_SPACEDIM*p(i,j,k);
+            AMREX_D_TERM(r += Real(4./3.)*(p(i-1,j,k)+p(i+1,j,k)) - Real(1./12.)*(p(i-2,j,k)+p(i+2,j,k));,
+                         r += Real(4./3.)*(p(i,j-1,k)+p(i,j+1,k)) - Real(1./12.)*(p(i,j-2,k)+p(i,j+2,k));,
+                         r += Real(4./3.)*(p(i,j,k-1)+p(i,j,k+1)) - Real(1./12.)*(p(i,j,k-2)+p(i,j,k+2)););
+            return r;
+        };
+
+        phi.FillBoundary(geom.periodicity());
+        auto const& rma = lap_ref.arrays();
+        ParallelFor(lap_ref, [=] AMREX_GPU_DEVICE (int box_no, int i, int j, int k) noexcept
+        {
+            rma[box_no](i,j,k) = stencil(box_no,i,j,k);
+        });
+
+        phi.setBndry(std::numeric_limits<Real>::quiet_NaN());
+        lap.setVal(std::numeric_limits<Real>::quiet_NaN());
+
+        phi.FillBoundary_nowait(geom.periodicity());
+        auto const& lma = lap.arrays();
+        ParallelFor(lap, IntVect(2), phi,
+        [=] AMREX_GPU_DEVICE (int box_no, int i, int j, int k) noexcept
+        {
+            lma[box_no](i,j,k) = stencil(box_no,i,j,k);
+        });
+
+        AMREX_ALWAYS_ASSERT(!lap.contains_nan(0, 1, 0));
+        MultiFab::Subtract(lap, lap_ref, 0, 0, 1, 0);
+        Real err = lap.norminf(0, 0);
+        amrex::Print() << "Max difference from the blocking FillBoundary: " << err << '\n';
+        AMREX_ALWAYS_ASSERT(err == Real(0.0));
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,120 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+namespace {
+
+// Fill ghost cells with and without fabarray.fb_persistent_comm for nsteps
+// steps with new data in every step, and return the max difference.  In
+// each step, two MultiFabs sharing the FB are filled at the same time, and
+// a ParallelCopy is done in between so that other messages are in flight.
+Real compare (Geometry const& geom, IntVect const& max_grid_size, int nsteps)
+{
+    BoxArray ba(geom.Domain());
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    BoxArray ba2(geom.Domain());
+    ba2.maxSize(max_grid_size/2);
+    DistributionMapping dm2(ba2);
+
+    Real err = 0.0;
+    for (int ncomp : {1, 3}) {
+        const int ng = 2;
+        MultiFab a(ba, dm, ncomp, ng);
+        MultiFab b(ba, dm, ncomp, ng);
+        MultiFab c(ba, dm, ncomp, ng);
+        MultiFab ref_a(ba, dm, ncomp, ng);
+        MultiFab ref_b(ba, dm, ncomp, ng);
+        MultiFab other(ba2, dm2, ncomp, 0);
+
+        for (int step = 0; step < nsteps; ++step)
+        {
+            FillRandom(a, 0, ncomp);
+            FillRandom(b, 0, ncomp);
+            FillRandom(other, 0, ncomp);
+            MultiFab::Copy(ref_a, a, 0, 0, ncomp, 0);
+            MultiFab::Copy(ref_b, b, 0, 0, ncomp, 0);
+            for (auto* mf : {&a, &b, &ref_a, &ref_b}) {
+                mf->setBndry(std::numeric_limits<Real>::quiet_NaN());
+            }
+
+            FabArrayBase::fb_persistent_comm = false;
+            ref_a.FillBoundary(geom.periodicity());
+            ref_b.FillBoundary(geom.periodicity());
+
+            FabArrayBase::fb_persistent_comm = true;
+            a.FillBoundary_nowait(geom.periodicity());
+            b.FillBoundary_nowait(geom.periodicity());
+            FabArrayBase::fb_persistent_comm = false;
+            c.ParallelCopy(other, 0, 0, ncomp);
+            b.FillBoundary_finish();
+            a.FillBoundary_finish();
+
+            for (auto* mf : {&a, &b}) {
+                AMREX_ALWAYS_ASSERT(!mf->contains_nan(0, ncomp, ng));
+            }
+            MultiFab::Subtract(a, ref_a, 0, 0, ncomp, ng);
+            MultiFab::Subtract(b, ref_b, 0, 0, ncomp, ng);
+            err = std::max({err, a.norminf(0, ncomp, IntVect(ng)),
+                                 b.norminf(0, ncomp, IntVect(ng))});
+        }
+    }
+    return err;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 8;
+        int nsteps = 4;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+        }
+
+        Box domain(IntVect(0),IntVect(n_cell-1));
+        Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                      0, {AMREX_D_DECL(1,1,1)});
+
+        // With two boxes, some processes have nothing to send or receive,
+        // but they must still take part in creating the persistent requests.
+        Real err = compare(geom, IntVect(AMREX_D_DECL(n_cell/2,n_cell,n_cell)), nsteps);
+        amrex::Print() << "Max difference with two boxes: " << err << '\n';
+        AMREX_ALWAYS_ASSERT(err == Real(0.0));
+
+        err = compare(geom, IntVect(max_grid_size), nsteps);
+        amrex::Print() << "Max difference from the default FillBoundary: " << err << '\n';
+        AMREX_ALWAYS_ASSERT(err == Real(0.0));
+
+#ifdef AMREX_USE_MPI
+        // The same in two sub-communicators, whose persistent requests use
+        // communicators of their own.
+        if (ParallelDescriptor::NProcs() > 1) {
+            MPI_Comm comm;
+            MPI_Comm_split(ParallelDescriptor::Communicator(),
+                           ParallelDescriptor::MyProc() % 2,
+                           ParallelDescriptor::MyProc(), &comm);
+            ParallelContext::push(comm);
+            err = std::max(compare(geom, IntVect(AMREX_D_DECL(n_cell/2,n_cell,n_cell)), nsteps),
+                           compare(geom, IntVect(max_grid_size), nsteps));
+            ParallelContext::pop();
+            FabArrayBase::flushFBCache();
+            MPI_Comm_free(&comm);
+            ParallelDescriptor::ReduceRealMax(err);
+            amrex::Print() << "Max difference in sub-communicators: " << err << '\n';
+            AMREX_ALWAYS_ASSERT(err == Real(0.0));
+        }
+#endif
+    }
+    amrex::Finalize();
+}
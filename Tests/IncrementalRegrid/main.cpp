@@ -0,0 +1,147 @@
+#include <AMReX.H>
+#include <AMReX_AmrCore.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_TagBox.H>
+
+using namespace amrex;
+
+// Regrid with amr.use_incremental_regrid = 1 while one tagged region stays
+// put and another one moves.  The fine boxes that are in both the old and the
+// new BoxArray must stay on their processes.  Then check that
+// MakeIncrementalDM falls back to a new DistributionMapping when keeping the
+// old owners would give a load balance worse than keep_eff times that of the
+// new one.  Finally, check that a MakeDistributionMap override is still used
+// when amr.use_incremental_regrid = 1.
+
+namespace {
+
+class IncrementalAmr
+    : public AmrCore
+{
+public:
+    using AmrCore::AmrCore;
+
+    // Tagged region of each step: a fixed one and a moving one
+    Vector<BoxArray> tagged;
+    int step = 0;
+    Long nkept = 0;
+    // Put all the boxes on the last process instead
+    bool custom_dm = false;
+    int ncustom = 0;
+    int nremade = 0;
+
+    DistributionMapping MakeDistributionMap (int lev, BoxArray const& ba) override
+    {
+        if (custom_dm) {
+            ++ncustom;
+            return DistributionMapping(Vector<int>(ba.size(), ParallelDescriptor::NProcs()-1));
+        }
+        return AmrCore::MakeDistributionMap(lev, ba);
+    }
+
+protected:
+    void MakeNewLevelFromScratch (int, Real, const BoxArray&, const DistributionMapping&) override {}
+    void MakeNewLevelFromCoarse (int, Real, const BoxArray&, const DistributionMapping&) override {}
+    void ClearLevel (int) override {}
+
+    void RemakeLevel (int lev, Real, const BoxArray& ba, const DistributionMapping& dm) override
+    {
+        ++nremade;
+        if (custom_dm) {
+            for (int i = 0; i < static_cast<int>(ba.size()); ++i) {
+                AMREX_ALWAYS_ASSERT(dm[i] == ParallelDescriptor::NProcs()-1);
+            }
+            return;
+        }
+        const BoxArray& old_ba = boxArray(lev);
+        const DistributionMapping& old_dm = DistributionMap(lev);
+        for (int i = 0; i < static_cast<int>(ba.size()); ++i) {
+            for (auto const& is : old_ba.intersections(ba[i])) {
+                if (old_ba[is.first] == ba[i]) {
+                    AMREX_ALWAYS_ASSERT(dm[i] == old_dm[is.first]);
+                    ++nkept;
+                }
+            }
+        }
+    }
+
+    void ErrorEst (int lev, TagBoxArray& tags, Real, int) override
+    {
+        if (lev == 0) {
+            tags.setVal(tagged[step], TagBox::SET);
+        }
+    }
+};
+
+void test_amrcore (bool custom_dm)
+{
+    int n_cell = 64;
+    int max_grid_size = 8;
+    {
+        ParmParse pp("amr");
+        pp.add("max_grid_size", max_grid_size);
+        pp.add("blocking_factor", max_grid_size);
+        pp.add("n_error_buf", 0);
+        pp.add("grid_eff", 1.0);
+        pp.add("use_incremental_regrid", 1);
+    }
+
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    IncrementalAmr amr(&rb, 1, Vector<int>(AMREX_SPACEDIM, n_cell), CoordSys::cartesian);
+    amr.custom_dm = custom_dm;
+
+    const Box fixed(IntVect(8), IntVect(23));
+    for (int s = 0; s < 3; ++s) {
+        const Box b(IntVect(32+s*8), IntVect(47+s*8));
+        amr.tagged.emplace_back(BoxList(Vector<Box>{fixed, b}));
+    }
+
+    amr.InitFromScratch(0.0);
+    for (amr.step = 1; amr.step < static_cast<int>(amr.tagged.size()); ++amr.step) {
+        amr.regrid(0, 0.0);
+    }
+
+    AMREX_ALWAYS_ASSERT(amr.nremade > 0);
+    if (custom_dm) {
+        amrex::Print() << "MakeDistributionMap override used " << amr.ncustom << " times\n";
+        AMREX_ALWAYS_ASSERT(amr.ncustom >= amr.nremade);
+    } else {
+        amrex::Print() << "Fine boxes kept across regrids: " << amr.nkept << "\n";
+        AMREX_ALWAYS_ASSERT(amr.nkept > 0);
+    }
+}
+
+void test_fallback ()
+{
+    BoxArray ba(Box(IntVect(0), IntVect(31)));
+    ba.maxSize(8);
+    const auto nboxes = static_cast<int>(ba.size());
+
+    // All boxes are on rank 0.  Keeping them there only pays off if the
+    // required efficiency is low enough.
+    const DistributionMapping old_dm(Vector<int>(nboxes, 0));
+    const DistributionMapping new_dm(ba);
+
+    const DistributionMapping kept = MakeIncrementalDM(ba, ba, old_dm, Real(0.0));
+    AMREX_ALWAYS_ASSERT(kept == old_dm);
+
+    const DistributionMapping dm = MakeIncrementalDM(ba, ba, old_dm, Real(0.9));
+    if (ParallelDescriptor::NProcs() > 1) {
+        AMREX_ALWAYS_ASSERT(dm == new_dm);
+    } else {
+        AMREX_ALWAYS_ASSERT(dm == old_dm);
+    }
+
+    amrex::Print() << "MakeIncrementalDM fallback passed\n";
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    test_amrcore(false);
+    test_fallback();
+    test_amrcore(true);
+    amrex::Finalize();
+}
@@ -13,7 +13,9 @@ MyTest::MyTest ()
 void
 MyTest::solve ()
 {
-    if (prob_type == 1) {
+    if (mixed_precision) {
+        solveMixedPrecision();
+    } else if (prob_type == 1) {
         if (single_precision) {
             solvePoisson<fMultiFab>();
         } else {
@@ -30,6 +32,122 @@ MyTest::solve ()
     }
 }
 
+void
+MyTest::solveMixedPrecision ()
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(composite_solve,
+                                     "mixed_precision only supports composite_solve");
+
+    LPInfo info;
+    info.setAgglomeration(agglomeration);
+    info.setConsolidation(consolidation);
+    info.setMaxCoarseningLevel(max_coarsening_level);
+
+    const Real tol_rel = 1.e-10;
+    const Real tol_abs = 0.0;
+
+    const auto nlevels = int(geom.size());
+
+    // The double precision operator has the Dirichlet values of the
+    // problem, whereas the single precision one solves for the correction
+    // with homogeneous BC.
+    auto setup = [&] (auto& linop, bool homogeneous)
+    {
+        using MF = typename std::decay_t<decltype(linop)>::MFType;
+        linop.setMaxOrder(linop_maxorder);
+        linop.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet)},
+                          {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet,
+                                        LinOpBCType::Dirichlet)});
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            linop.setLevelBC(ilev, homogeneous ? nullptr : &solution[ilev]);
+        }
+        if constexpr (std::is_same_v<std::decay_t<decltype(linop)>, MLABecLaplacianT<MF>>) {
+            linop.setScalars(ascalar, bscalar);
+            for (int ilev = 0; ilev < nlevels; ++ilev)
+            {
+                linop.setACoeffs(ilev, acoef[ilev]);
+
+                Array<MultiFab,AMREX_SPACEDIM> face_bcoef;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+                {
+                    const BoxArray& ba = amrex::convert(bcoef[ilev].boxArray(),
+                                                        IntVect::TheDimensionVector(idim));
+                    face_bcoef[idim].define(ba, bcoef[ilev].DistributionMap(), 1, 0);
+                }
+                amrex::average_cellcenter_to_face(GetArrOfPtrs(face_bcoef),
+                                                  bcoef[ilev], geom[ilev]);
+                linop.setBCoeffs(ilev, amrex::GetArrOfConstPtrs(face_bcoef));
+            }
+        }
+    };
+
+    auto mp_solve = [&] (auto& linop, auto& linop_lo)
+    {
+        setup(linop, false);
+        setup(linop_lo, true);
+
+        MLMG mlmg(linop);
+        MLMGT<fMultiFab> mlmg_lo(linop_lo);
+        mlmg_lo.setMaxFmgIter(max_fmg_iter);
+        mlmg_lo.setVerbose(0);
+        mlmg_lo.setBottomVerbose(bottom_verbose);
+
+        // The composite residual computed by the double precision operator
+        auto resnorm = [&] () -> Real
+        {
+            Vector<MultiFab> res(nlevels);
+            for (int ilev = 0; ilev < nlevels; ++ilev) {
+                res[ilev].define(grids[ilev], dmap[ilev], 1, 0);
+            }
+            mlmg.compResidual(GetVecOfPtrs(res), GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs));
+            Real r = 0.0;
+            for (int ilev = 0; ilev < nlevels; ++ilev) {
+                r = std::max(r, linop.normInf(ilev, res[ilev], true));
+            }
+            ParallelAllReduce::Max(r, ParallelContext::CommunicatorSub());
+            return r;
+        };
+
+        Real rhsnorm = 0.0;
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            rhsnorm = std::max(rhsnorm, linop.normInf(ilev, rhs[ilev], true));
+        }
+        ParallelAllReduce::Max(rhsnorm, ParallelContext::CommunicatorSub());
+        const Real resnorm0 = resnorm();
+
+        MixedPrecisionMLMG mpmlmg(mlmg, mlmg_lo);
+        mpmlmg.setMaxIter(max_iter);
+        mpmlmg.setVerbose(verbose);
+        mpmlmg.solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), tol_rel, tol_abs);
+
+        // Check the result independently of the solver.
+        const Real final_resnorm = resnorm();
+        const Real res_target = tol_rel * std::max(rhsnorm, resnorm0);
+        amrex::Print() << "Mixed precision: " << mpmlmg.getNumIters() << " outer iterations, "
+                       << mpmlmg.getNumInnerIters() << " single precision cycles, "
+                       << "final residual " << final_resnorm << " (target " << res_target << ")\n";
+        AMREX_ALWAYS_ASSERT(final_resnorm <= res_target);
+        if (max_outer_iter >= 0) {
+            AMREX_ALWAYS_ASSERT(mpmlmg.getNumIters() <= max_outer_iter);
+        }
+    };
+
+    if (prob_type == 1) {
+        MLPoisson linop(geom, grids, dmap, info);
+        MLPoissonT<fMultiFab> linop_lo(geom, grids, dmap, info);
+        mp_solve(linop, linop_lo);
+    } else if (prob_type == 2) {
+        MLABecLaplacian linop(geom, grids, dmap, info);
+        MLABecLaplacianT<fMultiFab> linop_lo(geom, grids, dmap, info);
+        mp_solve(linop, linop_lo);
+    } else {
+        amrex::Abort("Unknown prob_type");
+    }
+}
+
 void
 MyTest::readParameters ()
 {
@@ -44,6 +162,8 @@ MyTest::readParameters ()
     pp.query("prob_type", prob_type);
 
     pp.query("single_precision", single_precision);
+    pp.query("mixed_precision", mixed_precision);
+    pp.query("max_outer_iter", max_outer_iter);
 
     pp.query("verbose", verbose);
     pp.query("bottom_verbose", bottom_verbose);
@@ -0,0 +1,145 @@
+#include <AMReX.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace amrex;
+
+// For each of the given domain sizes, solve a Poisson problem with each of
+// the given bottom solvers, and check that every bottom solve converges and
+// that the solutions agree with the one obtained with the first bottom
+// solver.  "amg_fallback" is amg with a size limit that makes it fall back
+// to its Krylov solver.
+
+namespace {
+
+BottomSolver bottom_solver_from_string (std::string const& s)
+{
+    if (s == "default")      { return BottomSolver::Default; }
+    if (s == "bicgstab")     { return BottomSolver::bicgstab; }
+    if (s == "cg")           { return BottomSolver::cg; }
+    if (s == "pipebicgstab") { return BottomSolver::pipebicgstab; }
+    if (s == "pipecg")       { return BottomSolver::pipecg; }
+    if (s == "sstepcg")      { return BottomSolver::sstepcg; }
+    if (s == "amg" ||
+        s == "amg_fallback") { return BottomSolver::amg; }
+    amrex::Abort("Unknown bottom solver " + s);
+    return BottomSolver::Default;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        Vector<int> n_cells{48};
+        int max_grid_size = 12;
+        int max_coarsening_level = 2;
+        int bottom_maxiter = 200;
+        Vector<std::string> bottom_solvers{"bicgstab"};
+        Real tol_rel = Real(1.e-10);
+        int verbose = 0;
+        {
+            ParmParse pp;
+            pp.queryarr("n_cell", n_cells);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("max_coarsening_level", max_coarsening_level);
+            pp.query("bottom_maxiter", bottom_maxiter);
+            pp.queryarr("bottom_solver", bottom_solvers);
+            pp.query("tol_rel", tol_rel);
+            pp.query("verbose", verbose);
+        }
+
+        for (int n_cell : n_cells)
+        {
+            Geometry geom(Box(IntVect(0), IntVect(n_cell-1)),
+                          RealBox({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)}),
+                          CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+            BoxArray ba(geom.Domain());
+            ba.maxSize(max_grid_size);
+            DistributionMapping dm(ba);
+
+            MultiFab rhs(ba, dm, 1, 0);
+            {
+                const auto dx = geom.CellSizeArray();
+                constexpr Real tpi = Real(2.0)*Math::pi<Real>();
+                auto const& ra = rhs.arrays();
+                ParallelFor(rhs, [=] AMREX_GPU_DEVICE (int b, int i, int j, int k) noexcept
+                {
+                    ra[b](i,j,k) = AMREX_D_TERM( std::sin(tpi*(Real(i)+Real(0.5))*dx[0]),
+                                                *std::cos(tpi*(Real(j)+Real(0.5))*dx[1]),
+                                                *std::sin(Real(3.0)*tpi*(Real(k)+Real(0.5))*dx[2]));
+                });
+            }
+
+            LPInfo info;
+            info.setMaxCoarseningLevel(max_coarsening_level);
+
+            MultiFab ref_soln;
+            int ref_iters = 0;
+            for (auto const& bottom : bottom_solvers)
+            {
+                MLPoisson mlpoisson({geom}, {ba}, {dm}, info);
+                mlpoisson.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                                    LinOpBCType::Dirichlet,
+                                                    LinOpBCType::Dirichlet)},
+                                      {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                                    LinOpBCType::Dirichlet,
+                                                    LinOpBCType::Dirichlet)});
+                mlpoisson.setLevelBC(0, nullptr);
+
+                MultiFab soln(ba, dm, 1, 1);
+                soln.setVal(0.0);
+
+                MLMG mlmg(mlpoisson);
+                mlmg.setVerbose(verbose);
+                mlmg.setBottomSolver(bottom_solver_from_string(bottom));
+                mlmg.setBottomMaxIter(bottom_maxiter);
+                if (bottom == "amg_fallback") {
+                    mlmg.setAMGMaxBottomSize(0);
+                    mlmg.setAMGFallbackSolver(BottomSolver::cg);
+                }
+                mlmg.solve({&soln}, {&rhs}, tol_rel, Real(0.0));
+                if (bottom == "amg_fallback") {
+                    AMREX_ALWAYS_ASSERT(mlmg.getBottomSolver() == BottomSolver::cg);
+                } else if (bottom == "amg") {
+                    AMREX_ALWAYS_ASSERT(mlmg.getBottomSolver() == BottomSolver::amg);
+                }
+
+                const int niters = mlmg.getNumIters();
+                const Real resid = mlmg.getFinalResidual() / mlmg.getInitResidual();
+                auto const& cg_iters = mlmg.getNumCGIters();
+                const int max_cg_iters = cg_iters.empty() ? 0
+                    : *std::max_element(cg_iters.begin(), cg_iters.end());
+
+                amrex::Print() << "n_cell " << n_cell << ", bottom solver " << bottom
+                               << ": MLMG iterations " << niters
+                               << ", max bottom iterations " << max_cg_iters
+                               << ", relative residual " << resid << "\n";
+
+                AMREX_ALWAYS_ASSERT(resid <= tol_rel);
+                AMREX_ALWAYS_ASSERT(!cg_iters.empty() && max_cg_iters < bottom_maxiter);
+
+                if (ref_soln.empty()) {
+                    ref_soln.define(ba, dm, 1, 0);
+                    MultiFab::Copy(ref_soln, soln, 0, 0, 1, 0);
+                    ref_iters = niters;
+                } else {
+                    // The bottom solves converge to the same tolerance, so
+                    // the number of V-cycles should be about the same.
+                    AMREX_ALWAYS_ASSERT(std::abs(niters-ref_iters) <= 1);
+                    MultiFab::Subtract(soln, ref_soln, 0, 0, 1, 0);
+                    const Real diff = soln.norminf(0) / ref_soln.norminf(0);
+                    amrex::Print() << "    relative difference from " << bottom_solvers[0]
+                                   << ": " << diff << "\n";
+                    AMREX_ALWAYS_ASSERT(diff < Real(100.)*tol_rel);
+                }
+            }
+        }
+    }
+    amrex::Finalize();
+}
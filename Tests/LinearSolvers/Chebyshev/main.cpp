@@ -0,0 +1,163 @@
+#include <AMReX.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLNodeLaplacian.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+// Solve cell-centered and nodal Poisson problems with the operators' own
+// Gauss-Seidel smoother and with Chebyshev smoothers of the given degrees.
+// Check that the Chebyshev solves reach the same tolerance in a bounded
+// number of V-cycles and agree with the Gauss-Seidel solution.
+
+namespace {
+
+struct Params
+{
+    int max_iter = 100;
+    Real tol_rel = Real(1.e-10);
+    int verbose = 0;
+};
+
+struct Result
+{
+    int niters = 0;
+    Real resid = 0;
+};
+
+void set_dirichlet_bc (MLLinOp& linop)
+{
+    linop.setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                    LinOpBCType::Dirichlet,
+                                    LinOpBCType::Dirichlet)},
+                      {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                    LinOpBCType::Dirichlet,
+                                    LinOpBCType::Dirichlet)});
+}
+
+// Solve with the smoother selected by chebyshev_degree (0: Gauss-Seidel)
+Result solve (MLLinOp& linop, MultiFab& soln, MultiFab const& rhs, int chebyshev_degree,
+              Params const& p)
+{
+    if (chebyshev_degree > 0) {
+        linop.setChebyshevSmoother(true, chebyshev_degree);
+    }
+
+    soln.setVal(0.0);
+
+    MLMG mlmg(linop);
+    mlmg.setMaxIter(p.max_iter);
+    mlmg.setVerbose(p.verbose);
+    mlmg.solve({&soln}, {&rhs}, p.tol_rel, Real(0.0));
+
+    return Result{mlmg.getNumIters(), mlmg.getFinalResidual()/mlmg.getInitResidual()};
+}
+
+void fill_rhs (MultiFab& rhs, Geometry const& geom)
+{
+    const auto problo = geom.ProbLoArray();
+    const auto dx = geom.CellSizeArray();
+    const IntVect ixtype = rhs.ixType().toIntVect();
+    constexpr Real tpi = Real(2.0)*Math::pi<Real>();
+    auto const& ra = rhs.arrays();
+    ParallelFor(rhs, [=] AMREX_GPU_DEVICE (int b, int i, int j, int k) noexcept
+    {
+        IntVect iv(AMREX_D_DECL(i,j,k));
+        Real x[AMREX_SPACEDIM];
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            x[idim] = problo[idim] + (Real(iv[idim]) + (ixtype[idim] ? Real(0.0) : Real(0.5)))*dx[idim];
+        }
+        ra[b](i,j,k) = AMREX_D_TERM( std::sin(tpi*x[0]),
+                                    *std::cos(tpi*x[1]),
+                                    *std::sin(Real(3.0)*tpi*x[2]));
+    });
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        Vector<int> chebyshev_degrees{2};
+        Real max_iter_ratio = 2.0;
+        Params p;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.queryarr("chebyshev_degree", chebyshev_degrees);
+            pp.query("max_iter_ratio", max_iter_ratio);
+            pp.query("max_iter", p.max_iter);
+            pp.query("tol_rel", p.tol_rel);
+            pp.query("verbose", p.verbose);
+        }
+
+        Geometry geom(Box(IntVect(0), IntVect(n_cell-1)),
+                      RealBox({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)}),
+                      CoordSys::cartesian, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        for (bool nodal : {false, true})
+        {
+            const BoxArray rba = nodal ? amrex::convert(ba, IntVect(1)) : ba;
+            MultiFab rhs(rba, dm, 1, 0);
+            fill_rhs(rhs, geom);
+
+            MultiFab sigma;
+            if (nodal) {
+                sigma.define(ba, dm, 1, 0);
+                sigma.setVal(1.0);
+            }
+
+            MultiFab gs_soln;
+            int gs_iters = 0;
+            for (int i = -1; i < int(chebyshev_degrees.size()); ++i)
+            {
+                const int degree = (i < 0) ? 0 : chebyshev_degrees[i];
+                MultiFab soln(rba, dm, 1, 1);
+                Result r;
+                if (nodal) {
+                    MLNodeLaplacian linop({geom}, {ba}, {dm});
+                    set_dirichlet_bc(linop);
+                    linop.setSigma(0, sigma);
+                    r = solve(linop, soln, rhs, degree, p);
+                } else {
+                    MLPoisson linop({geom}, {ba}, {dm});
+                    set_dirichlet_bc(linop);
+                    linop.setLevelBC(0, nullptr);
+                    r = solve(linop, soln, rhs, degree, p);
+                }
+
+                amrex::Print() << (nodal ? "Nodal" : "Cell-centered") << " Poisson, "
+                               << (degree == 0 ? std::string("Gauss-Seidel")
+                                               : "Chebyshev degree " + std::to_string(degree))
+                               << ": " << r.niters << " iterations, relative residual "
+                               << r.resid << "\n";
+
+                AMREX_ALWAYS_ASSERT(r.resid <= p.tol_rel);
+
+                if (degree == 0) {
+                    gs_soln.define(rba, dm, 1, 0);
+                    MultiFab::Copy(gs_soln, soln, 0, 0, 1, 0);
+                    gs_iters = r.niters;
+                } else {
+                    AMREX_ALWAYS_ASSERT(Real(r.niters) <= max_iter_ratio*Real(gs_iters));
+                    MultiFab::Subtract(soln, gs_soln, 0, 0, 1, 0);
+                    const Real diff = soln.norminf(0) / gs_soln.norminf(0);
+                    amrex::Print() << "    relative difference from Gauss-Seidel: "
+                                   << diff << "\n";
+                    AMREX_ALWAYS_ASSERT(diff < Real(100.)*p.tol_rel);
+                }
+            }
+        }
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,304 @@
+#include <AMReX.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_ParallelReduce.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+using namespace amrex;
+
+// Sweep MLMG solves of a Poisson problem over problem sizes, AMR levels,
+// bottom solvers and LPInfo options, and write the timings and convergence
+// rates as JSON.  To sweep MPI ranks and OpenMP threads, run the executable
+// repeatedly with different json_file names (see run-sweep.sh).
+
+namespace {
+
+struct Params
+{
+    Vector<int> n_cell{64};
+    Vector<int> max_level{0};
+    Vector<std::string> bottom_solver{"bicgstab"};
+    Vector<int> agglomeration{1};
+    Vector<int> consolidation{1};
+    Vector<int> max_coarsening_level{30};
+    int max_grid_size = 32;
+    int ref_ratio = 2;
+    int max_iter = 100;
+    int max_fmg_iter = 0;
+    int linop_maxorder = 2;
+    int bottom_sstep = 4;
+    int chebyshev_degree = 0; // 0: the operator's own smoother
+    int reuse_linop = 0; // 1: define the operator and MLMG once for all repeats
+    Real tol_rel = Real(1.e-10);
+    int nwarmup = 1;
+    int nrepeat = 3;
+    int verbose = 0;
+    std::string json_file{"mlmg_benchmark.json"};
+};
+
+struct Result
+{
+    int niters = 0;
+    Real conv_rate = Real(0.0);
+    Real final_resid = Real(0.0);
+    double define_time = 0.0;
+    Vector<double> timer;
+};
+
+bool bottom_solver_from_string (std::string const& s, BottomSolver& bs)
+{
+    if (s == "default")      { bs = BottomSolver::Default;      return true; }
+    if (s == "smoother")     { bs = BottomSolver::smoother;     return true; }
+    if (s == "bicgstab")     { bs = BottomSolver::bicgstab;     return true; }
+    if (s == "cg")           { bs = BottomSolver::cg;           return true; }
+    if (s == "bicgcg")       { bs = BottomSolver::bicgcg;       return true; }
+    if (s == "cgbicg")       { bs = BottomSolver::cgbicg;       return true; }
+    if (s == "pipebicgstab") { bs = BottomSolver::pipebicgstab; return true; }
+    if (s == "pipecg")       { bs = BottomSolver::pipecg;       return true; }
+    if (s == "sstepcg")      { bs = BottomSolver::sstepcg;      return true; }
+    if (s == "amg")          { bs = BottomSolver::amg;          return true; }
+#ifdef AMREX_USE_HYPRE
+    if (s == "hypre")        { bs = BottomSolver::hypre;        return true; }
+#endif
+#ifdef AMREX_USE_PETSC
+    if (s == "petsc")        { bs = BottomSolver::petsc;        return true; }
+#endif
+    return false;
+}
+
+Result run_one (Params const& p, int n_cell, int max_level, BottomSolver bottom_solver,
+                LPInfo const& info)
+{
+    const int nlevels = max_level + 1;
+
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Array<int,AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0,0,0)};
+    Vector<Geometry> geom(nlevels);
+    Vector<BoxArray> grids(nlevels);
+    Vector<DistributionMapping> dmap(nlevels);
+    Vector<MultiFab> solution(nlevels);
+    Vector<MultiFab> rhs(nlevels);
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    Box fine_region = domain;
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        geom[ilev].define(domain, rb, CoordSys::cartesian, is_periodic);
+        grids[ilev].define(fine_region);
+        grids[ilev].maxSize(p.max_grid_size);
+        dmap[ilev].define(grids[ilev]);
+        solution[ilev].define(grids[ilev], dmap[ilev], 1, 1);
+        rhs[ilev].define(grids[ilev], dmap[ilev], 1, 0);
+
+        // fine level covers the middle of the coarse level
+        domain.refine(p.ref_ratio);
+        fine_region.grow(-fine_region.length(0)/4);
+        fine_region.refine(p.ref_ratio);
+    }
+
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        const auto dx = geom[ilev].CellSizeArray();
+        constexpr Real tpi = Real(2.0)*Math::pi<Real>();
+        for (MFIter mfi(rhs[ilev], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            auto const& r = rhs[ilev].array(mfi);
+            amrex::ParallelFor(mfi.tilebox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                r(i,j,k) = AMREX_D_TERM( std::sin(tpi*(Real(i)+Real(0.5))*dx[0]),
+                                        *std::sin(tpi*(Real(j)+Real(0.5))*dx[1]),
+                                        *std::sin(tpi*(Real(k)+Real(0.5))*dx[2]));
+            });
+        }
+    }
+
+    Result result;
+    result.timer.assign(MLMG::ntimers, 0.0);
+
+    std::unique_ptr<MLPoisson> mlpoisson;
+    std::unique_ptr<MLMG> mlmg;
+
+    for (int irep = 0; irep < p.nwarmup + p.nrepeat; ++irep)
+    {
+        for (auto& s : solution) { s.setVal(Real(0.0)); }
+
+        ParallelDescriptor::Barrier();
+        double t0 = amrex::second();
+
+        // With reuse_linop, the hierarchy built for the first solve is kept
+        // as it would be for a time step that did not change the grids.
+        if (!p.reuse_linop || !mlpoisson || !mlpoisson->hasSameGrids(geom, grids, dmap))
+        {
+            mlmg.reset();
+            mlpoisson = std::make_unique<MLPoisson>(geom, grids, dmap, info);
+            mlpoisson->setMaxOrder(p.linop_maxorder);
+            if (p.chebyshev_degree > 0) {
+                mlpoisson->setChebyshevSmoother(true, p.chebyshev_degree);
+            }
+            mlpoisson->setDomainBC({AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                                 LinOpBCType::Dirichlet,
+                                                 LinOpBCType::Dirichlet)},
+                                   {AMREX_D_DECL(LinOpBCType::Dirichlet,
+                                                 LinOpBCType::Dirichlet,
+                                                 LinOpBCType::Dirichlet)});
+
+            mlmg = std::make_unique<MLMG>(*mlpoisson);
+            mlmg->setMaxIter(p.max_iter);
+            mlmg->setMaxFmgIter(p.max_fmg_iter);
+            mlmg->setVerbose(p.verbose);
+            mlmg->setBottomSolver(bottom_solver);
+            mlmg->setBottomSStep(p.bottom_sstep);
+        }
+        for (int ilev = 0; ilev < nlevels; ++ilev) {
+            mlpoisson->setLevelBC(ilev, &solution[ilev]);
+        }
+
+        double define_time = amrex::second() - t0;
+
+        ParallelDescriptor::Barrier();
+        mlmg->solve(GetVecOfPtrs(solution), GetVecOfConstPtrs(rhs), p.tol_rel, Real(0.0));
+
+        if (irep < p.nwarmup) { continue; }
+
+        ParallelReduce::Max<double>(define_time, ParallelDescriptor::IOProcessorNumber(),
+                                    ParallelDescriptor::Communicator());
+        result.define_time += define_time / p.nrepeat;
+
+        Vector<double> t = mlmg->getTimers();
+        ParallelReduce::Max<double>(t.data(), static_cast<int>(t.size()),
+                                    ParallelDescriptor::IOProcessorNumber(),
+                                    ParallelDescriptor::Communicator());
+        for (int i = 0; i < MLMG::ntimers; ++i) {
+            result.timer[i] += t[i] / p.nrepeat;
+        }
+
+        result.niters = mlmg->getNumIters();
+        result.final_resid = mlmg->getFinalResidual();
+        Real r0 = mlmg->getInitResidual();
+        if (result.niters > 0 && r0 > Real(0.0)) {
+            result.conv_rate = std::pow(mlmg->getResidualHistory().back()/r0,
+                                        Real(1.0)/Real(result.niters));
+        }
+    }
+
+    return result;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        BL_PROFILE("main");
+
+        Params p;
+        {
+            ParmParse pp;
+            pp.queryarr("n_cell", p.n_cell);
+            pp.queryarr("max_level", p.max_level);
+            pp.queryarr("bottom_solver", p.bottom_solver);
+            pp.queryarr("agglomeration", p.agglomeration);
+            pp.queryarr("consolidation", p.consolidation);
+            pp.queryarr("max_coarsening_level", p.max_coarsening_level);
+            pp.query("max_grid_size", p.max_grid_size);
+            pp.query("ref_ratio", p.ref_ratio);
+            pp.query("max_iter", p.max_iter);
+            pp.query("max_fmg_iter", p.max_fmg_iter);
+            pp.query("linop_maxorder", p.linop_maxorder);
+            pp.query("bottom_sstep", p.bottom_sstep);
+            pp.query("chebyshev_degree", p.chebyshev_degree);
+            pp.query("reuse_linop", p.reuse_linop);
+            pp.query("tol_rel", p.tol_rel);
+            pp.query("nwarmup", p.nwarmup);
+            pp.query("nrepeat", p.nrepeat);
+            pp.query("verbose", p.verbose);
+            pp.query("json_file", p.json_file);
+        }
+        AMREX_ALWAYS_ASSERT(p.nrepeat > 0);
+
+        std::ostringstream json;
+        json << std::setprecision(8);
+        json << "{\n"
+             << "  \"dim\": " << AMREX_SPACEDIM << ",\n"
+             << "  \"nprocs\": " << ParallelDescriptor::NProcs() << ",\n"
+             << "  \"nthreads\": " << OpenMP::get_max_threads() << ",\n"
+             << "  \"max_grid_size\": " << p.max_grid_size << ",\n"
+             << "  \"max_fmg_iter\": " << p.max_fmg_iter << ",\n"
+             << "  \"chebyshev_degree\": " << p.chebyshev_degree << ",\n"
+             << "  \"reuse_linop\": " << p.reuse_linop << ",\n"
+             << "  \"tol_rel\": " << p.tol_rel << ",\n"
+             << "  \"nrepeat\": " << p.nrepeat << ",\n"
+             << "  \"runs\": [";
+
+        bool first = true;
+        for (int n_cell : p.n_cell) {
+        for (int max_level : p.max_level) {
+        for (auto const& bottom : p.bottom_solver) {
+        for (int agg : p.agglomeration) {
+        for (int con : p.consolidation) {
+        for (int mcl : p.max_coarsening_level) {
+            BottomSolver bs;
+            if (!bottom_solver_from_string(bottom, bs)) {
+                amrex::Print() << "Skipping unknown or unavailable bottom solver " << bottom << "\n";
+                continue;
+            }
+
+            LPInfo info;
+            info.setAgglomeration(agg);
+            info.setConsolidation(con);
+            info.setMaxCoarseningLevel(mcl);
+
+            Result r = run_one(p, n_cell, max_level, bs, info);
+            const auto& t = r.timer;
+            const double vcycle = (r.niters > 0) ? t[MLMG::iter_time]/r.niters : 0.0;
+
+            amrex::Print() << "n_cell " << n_cell << " max_level " << max_level
+                           << " bottom " << bottom << " agg " << agg << " con " << con
+                           << " mcl " << mcl << ": iters " << r.niters
+                           << ", define " << r.define_time
+                           << ", solve " << t[MLMG::solve_time]
+                           << ", per cycle " << vcycle
+                           << ", rate " << r.conv_rate << "\n";
+
+            json << (first ? "\n" : ",\n");
+            first = false;
+            json << "    {\"n_cell\": " << n_cell
+                 << ", \"max_level\": " << max_level
+                 << ", \"bottom_solver\": \"" << bottom << "\""
+                 << ", \"agglomeration\": " << agg
+                 << ", \"consolidation\": " << con
+                 << ", \"max_coarsening_level\": " << mcl
+                 << ",\n     \"iterations\": " << r.niters
+                 << ", \"convergence_rate\": " << r.conv_rate
+                 << ", \"final_residual\": " << r.final_resid
+                 << ",\n     \"define_time\": " << r.define_time
+                 << ", \"solve_time\": " << t[MLMG::solve_time]
+                 << ", \"setup_time\": " << t[MLMG::solve_time] - t[MLMG::iter_time]
+                 << ", \"iter_time\": " << t[MLMG::iter_time]
+                 << ", \"time_per_cycle\": " << vcycle
+                 << ",\n     \"smooth_time\": " << t[MLMG::smooth_time]
+                 << ", \"restrict_time\": " << t[MLMG::restrict_time]
+                 << ", \"interp_time\": " << t[MLMG::interp_time]
+                 << ", \"bottom_time\": " << t[MLMG::bottom_time] << "}";
+        }}}}}}
+
+        json << "\n  ]\n}\n";
+
+        if (ParallelDescriptor::IOProcessor()) {
+            std::ofstream ofs(p.json_file);
+            ofs << json.str();
+            if (!ofs.good()) {
+                amrex::Abort("Failed to write " + p.json_file);
+            }
+        }
+    }
+    amrex::Finalize();
+}
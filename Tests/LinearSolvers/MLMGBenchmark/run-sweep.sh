@@ -0,0 +1,14 @@
+#!/bin/bash
+# Run the benchmark for a range of MPI ranks and OpenMP threads.  Each run
+# writes its own JSON file.
+
+EXE=${EXE:-./main3d.gnu.MPI.OMP.ex}
+INPUTS=${INPUTS:-inputs}
+MPIRUN=${MPIRUN:-mpiexec -n}
+
+for np in ${NPROCS:-1 2 4}; do
+    for nt in ${NTHREADS:-1 2}; do
+        OMP_NUM_THREADS=${nt} ${MPIRUN} ${np} ${EXE} ${INPUTS} \
+            json_file=mlmg_np${np}_nt${nt}.json
+    done
+done
@@ -0,0 +1,163 @@
+#include <AMReX.H>
+#include <AMReX_OpenBC.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+// Solve for the potential of a uniformly charged sphere with open boundary
+// conditions.  With opening angle 0, the potential on the boundary is a
+// direct sum over all the multipole blocks, and the solution is checked
+// against a direct sum of the Green's function over all the charged cells.
+// The solution with a nonzero opening angle is then checked against the one
+// with opening angle 0.
+
+namespace {
+
+struct Charge
+{
+    Real x, y, z, q;
+};
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 32;
+        Real radius = Real(0.4);
+        Real theta = Real(0.3);
+        Real tol_rel = Real(1.e-11);
+        Real tol_direct = Real(1.e-3);
+        Real tol_theta = Real(1.e-7);
+        int sample_stride = 4;
+        int verbose = 0;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("radius", radius);
+            pp.query("theta", theta);
+            pp.query("tol_rel", tol_rel);
+            pp.query("tol_direct", tol_direct);
+            pp.query("tol_theta", tol_theta);
+            pp.query("sample_stride", sample_stride);
+            pp.query("verbose", verbose);
+        }
+
+        Geometry geom(Box(IntVect(0), IntVect(n_cell-1)),
+                      RealBox({-1.,-1.,-1.}, {1.,1.,1.}),
+                      CoordSys::cartesian, {0,0,0});
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        // The sphere is off center, so that the boundary potential is not
+        // symmetric.
+        const GpuArray<Real,3> center{Real(0.1), Real(-0.05), Real(0.07)};
+        const auto problo = geom.ProbLoArray();
+        const auto dx = geom.CellSizeArray();
+
+        MultiFab rhs(ba, dm, 1, 0);
+        auto const& ra = rhs.arrays();
+        ParallelFor(rhs, [=] AMREX_GPU_DEVICE (int b, int i, int j, int k) noexcept
+        {
+            const Real x = problo[0] + (Real(i)+Real(0.5))*dx[0] - center[0];
+            const Real y = problo[1] + (Real(j)+Real(0.5))*dx[1] - center[1];
+            const Real z = problo[2] + (Real(k)+Real(0.5))*dx[2] - center[2];
+            ra[b](i,j,k) = (x*x+y*y+z*z < radius*radius) ? Real(1.0) : Real(0.0);
+        });
+        Gpu::streamSynchronize();
+
+        // Every rank builds the list of all the charged cells.
+        Gpu::DeviceVector<Charge> charges;
+        {
+            Gpu::HostVector<Charge> h_charges;
+            const Real dv = dx[0]*dx[1]*dx[2];
+            amrex::LoopOnCpu(geom.Domain(), [&] (int i, int j, int k)
+            {
+                const Real x = problo[0] + (Real(i)+Real(0.5))*dx[0];
+                const Real y = problo[1] + (Real(j)+Real(0.5))*dx[1];
+                const Real z = problo[2] + (Real(k)+Real(0.5))*dx[2];
+                const Real rx = x - center[0];
+                const Real ry = y - center[1];
+                const Real rz = z - center[2];
+                if (rx*rx+ry*ry+rz*rz < radius*radius) {
+                    h_charges.push_back(Charge{x, y, z, dv});
+                }
+            });
+            charges.resize(h_charges.size());
+            Gpu::copyAsync(Gpu::hostToDevice, h_charges.begin(), h_charges.end(),
+                           charges.begin());
+            Gpu::streamSynchronize();
+        }
+
+        MultiFab phi0(ba, dm, 1, 1);
+        MultiFab phi(ba, dm, 1, 1);
+        for (auto* sol : {&phi0, &phi})
+        {
+            const Real angle = (sol == &phi0) ? Real(0.0) : theta;
+            sol->setVal(0.0);
+            OpenBCSolver solver({geom}, {ba}, {dm});
+            solver.setVerbose(verbose);
+            solver.setOpeningAngle(angle);
+            solver.solve({sol}, {&rhs}, tol_rel, Real(0.0));
+        }
+
+        // Compare with the direct sum on a coarse lattice of cells outside
+        // the sphere, where the discretization error of the charge is small.
+        Real direct_err = 0, direct_max = 0;
+        {
+            const auto* pcharges = charges.data();
+            const auto ncharges = static_cast<int>(charges.size());
+            const Real rmin = Real(1.5)*radius;
+            auto const& pa = phi0.const_arrays();
+            ReduceOps<ReduceOpMax, ReduceOpMax> reduce_op;
+            ReduceData<Real, Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(phi0, IntVect(0), reduce_data,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k) -> ReduceTuple
+            {
+                const Real x = problo[0] + (Real(i)+Real(0.5))*dx[0];
+                const Real y = problo[1] + (Real(j)+Real(0.5))*dx[1];
+                const Real z = problo[2] + (Real(k)+Real(0.5))*dx[2];
+                const Real rx = x - center[0];
+                const Real ry = y - center[1];
+                const Real rz = z - center[2];
+                if (i % sample_stride != 0 || j % sample_stride != 0 || k % sample_stride != 0 ||
+                    rx*rx+ry*ry+rz*rz < rmin*rmin)
+                {
+                    return {Real(0.0), Real(0.0)};
+                }
+                Real direct = 0;
+                for (int n = 0; n < ncharges; ++n) {
+                    const Real r = std::sqrt((x-pcharges[n].x)*(x-pcharges[n].x) +
+                                             (y-pcharges[n].y)*(y-pcharges[n].y) +
+                                             (z-pcharges[n].z)*(z-pcharges[n].z));
+                    direct -= pcharges[n].q / (Real(4.0)*Math::pi<Real>()*r);
+                }
+                return {std::abs(pa[b](i,j,k)-direct), std::abs(direct)};
+            });
+            auto const& hv = reduce_data.value(reduce_op);
+            direct_err = amrex::get<0>(hv);
+            direct_max = amrex::get<1>(hv);
+            ParallelAllReduce::Max(direct_err, ParallelContext::CommunicatorSub());
+            ParallelAllReduce::Max(direct_max, ParallelContext::CommunicatorSub());
+        }
+
+        MultiFab::Subtract(phi, phi0, 0, 0, 1, 0);
+        const Real theta_diff = phi.norminf(0) / phi0.norminf(0);
+
+        amrex::Print() << "Opening angle 0 vs. direct sum: relative difference "
+                       << direct_err/direct_max << "\n"
+                       << "Opening angle " << theta << " vs. 0: relative difference "
+                       << theta_diff << "\n";
+
+        AMREX_ALWAYS_ASSERT(direct_err <= tol_direct*direct_max);
+        AMREX_ALWAYS_ASSERT(theta_diff <= tol_theta);
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,118 @@
+#include <AMReX.H>
+#include <AMReX_MFTaskGraph.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+namespace {
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    Real laplacian (Array4<Real const> const& p, int i, int j, int k, int n) noexcept
+    {
+        Real r = Real(-2.0)*AMREX_SPACEDIM*p(i,j,k,n);
+        AMREX_D_TERM(r += p(i-1,j,k,n) + p(i+1,j,k,n);,
+                     r += p(i,j-1,k,n) + p(i,j+1,k,n);,
+                     r += p(i,j,k-1,n) + p(i,j,k+1,n););
+        return r;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 32;
+        int nsteps = 4;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nsteps", nsteps);
+        }
+
+        Box domain(IntVect(0),IntVect(n_cell-1));
+        Geometry geom(domain, RealBox(AMREX_D_DECL(0.,0.,0.),AMREX_D_DECL(1.,1.,1.)),
+                      0, {AMREX_D_DECL(1,1,1)});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        const Real dt = Real(0.1);
+        const int ncomp = 2;
+
+        MultiFab phi(ba, dm, ncomp, 1);
+        MultiFab phi_new(ba, dm, ncomp, 0);
+        MultiFab lap(ba, dm, ncomp, 0);
+        phi.setVal(0.0);
+        FillRandom(phi, 0, ncomp);
+
+        MultiFab phi_ref(ba, dm, ncomp, 1);
+        MultiFab::Copy(phi_ref, phi, 0, 0, ncomp, 0);
+
+        // Bulk-synchronous reference
+        for (int step = 0; step < 2*nsteps; ++step) {
+            phi_ref.FillBoundary(geom.periodicity());
+            auto const& pa = phi_ref.arrays();
+            auto const& la = lap.arrays();
+            ParallelFor(lap, IntVect(0), ncomp,
+            [=] AMREX_GPU_DEVICE (int box_no, int i, int j, int k, int n) noexcept
+            {
+                la[box_no](i,j,k,n) = laplacian(pa[box_no], i, j, k, n);
+            });
+            ParallelFor(phi_ref, IntVect(0), ncomp,
+            [=] AMREX_GPU_DEVICE (int box_no, int i, int j, int k, int n) noexcept
+            {
+                pa[box_no](i,j,k,n) += dt*la[box_no](i,j,k,n);
+            });
+        }
+
+        // Two time steps per graph, each as three stages
+        phi.setBndry(std::numeric_limits<Real>::quiet_NaN());
+        lap.setVal(std::numeric_limits<Real>::quiet_NaN());
+
+        MFTaskGraph tg;
+        auto const& pa = phi.arrays();
+        auto const& pna = phi_new.arrays();
+        auto const& la = lap.arrays();
+        for (int step = 0; step < 2; ++step) {
+            tg.addStage(lap, phi, IntVect(1), geom.periodicity(), {},
+                        [=] (int box_no, Box const& tbx)
+                        {
+                            ParallelFor(tbx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+                            {
+                                la[box_no](i,j,k,n) = laplacian(pa[box_no], i, j, k, n);
+                            });
+                        });
+            tg.addStage(phi_new, {&phi, &lap},
+                        [=] (int box_no, Box const& tbx)
+                        {
+                            ParallelFor(tbx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+                            {
+                                pna[box_no](i,j,k,n) = pa[box_no](i,j,k,n) + dt*la[box_no](i,j,k,n);
+                            });
+                        });
+            tg.addStage(phi, {&phi_new},
+                        [=] (int box_no, Box const& tbx)
+                        {
+                            ParallelFor(tbx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+                            {
+                                pa[box_no](i,j,k,n) = pna[box_no](i,j,k,n);
+                            });
+                        });
+        }
+
+        for (int step = 0; step < nsteps; ++step) {
+            tg.run();
+        }
+        amrex::Print() << "Number of tasks: " << tg.numTasks() << '\n';
+
+        AMREX_ALWAYS_ASSERT(!phi.contains_nan(0, ncomp, 0));
+        MultiFab::Subtract(phi, phi_ref, 0, 0, ncomp, 0);
+        Real err = phi.norminf(0, ncomp, IntVect(0));
+        amrex::Print() << "Max difference from the bulk-synchronous version: " << err << '\n';
+        AMREX_ALWAYS_ASSERT(err == Real(0.0));
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,109 @@
+#include <AMReX.H>
+#include <AMReX_CArena.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_Print.H>
+
+#include <vector>
+
+using namespace amrex;
+
+// Allocate and free blocks of random sizes on all the threads of a CArena
+// with thread caches, with some blocks freed by other threads and some
+// freed after the parallel region has ended.  The memory reported as used
+// must be that of the live blocks, whether or not the free blocks are still
+// held by the caches, and the rounding to the size classes must not waste
+// more than a quarter of a block.
+
+namespace {
+
+// The reported usage must be between the requested bytes and the bytes
+// rounded up to the size classes.
+void check_usage (CArena const& arena, std::size_t nrequested, char const* when)
+{
+    const std::size_t used = arena.heap_space_actually_used();
+    amrex::Print() << when << ": requested " << nrequested << " bytes, used " << used << "\n";
+    AMREX_ALWAYS_ASSERT(used >= nrequested);
+    AMREX_ALWAYS_ASSERT(used <= nrequested + nrequested/4);
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        CArena arena(0, ArenaInfo().SetCpuMemory().SetThreadCache());
+
+        const int nthreads = OpenMP::get_max_threads();
+        const int nblocks = 200;
+        const int nrounds = 10;
+
+        // Blocks allocated by each thread
+        std::vector<std::vector<void*>> blocks(nthreads);
+
+        for (int round = 0; round < nrounds; ++round)
+        {
+            std::size_t nrequested = 0;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel reduction(+:nrequested)
+#endif
+            {
+                const int tid = OpenMP::get_thread_num();
+                unsigned int seed = 12345u + 1000u*tid + 77u*round;
+                for (int i = 0; i < nblocks; ++i) {
+                    seed = seed*1103515245u + 12345u;
+                    // Between 256 bytes and 2 MB, in multiples of the alignment
+                    const std::size_t sz = Arena::align(256 + (seed >> 8) % (2*1024*1024));
+                    blocks[tid].push_back(arena.alloc(sz));
+                    nrequested += sz;
+                }
+            }
+            check_usage(arena, nrequested, "Allocated");
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+            {
+                // Free half of our blocks, and half of the blocks of the next
+                // thread.
+                const int tid = OpenMP::get_thread_num();
+                for (int i = 0; i < nblocks; i += 2) {
+                    arena.free(blocks[tid][i]);
+                    blocks[tid][i] = nullptr;
+                }
+#ifdef AMREX_USE_OMP
+#pragma omp barrier
+#endif
+                const int other = (tid+1) % nthreads;
+                for (int i = 1; i < nblocks; i += 2) {
+                    if (i % 4 == 1 || round == nrounds-1) {
+                        arena.free(blocks[other][i]);
+                        blocks[other][i] = nullptr;
+                    }
+                }
+            }
+
+            // The remaining blocks are freed outside the parallel region.
+            for (auto& b : blocks) {
+                for (void* p : b) {
+                    if (p) {
+                        arena.free(p);
+                    }
+                }
+                b.clear();
+            }
+
+            check_usage(arena, 0, "Freed");
+        }
+
+        if (ParallelDescriptor::IOProcessor()) {
+            arena.PrintUsage(amrex::OutStream(), "CArena", "");
+        }
+
+        amrex::Print() << "Heap space before freeUnused: " << arena.heap_space_used() << "\n";
+        arena.freeUnused();
+        amrex::Print() << "Heap space after freeUnused: " << arena.heap_space_used() << "\n";
+        AMREX_ALWAYS_ASSERT(arena.heap_space_used() == 0);
+    }
+    amrex::Finalize();
+}
@@ -1,6 +1,9 @@
 #include <AMReX.H>
 #include <AMReX_Parser.H>
 #include <AMReX_IParser.H>
+#include <AMReX_Utility.H>
+#include <cmath>
+#include <limits>
 #include <map>
 
 using namespace amrex;
@@ -149,6 +152,58 @@ int test4 (std::string const& f,
     }
 }
 
+int test_batch (std::string const& f,
+                std::map<std::string,Real> const& constants,
+                Array<Real,3> const& lo, Array<Real,3> const& hi,
+                int N, Real reltol)
+{
+    amrex::Print() << test_number++ << ". Batch testing \"" << f << "\"\n";
+
+    Parser parser(f);
+    for (auto const& kv : constants) {
+        parser.setConstant(kv.first, kv.second);
+    }
+    parser.registerVariables({"x","y","z"});
+    auto const exe = parser.compileHost<3>();
+
+    Vector<double> x(N), y(N), z(N);
+    for (int i = 0; i < N; ++i) {
+        // Scattered points so that branches differ within a batch
+        Real fx = Real((i*7919) % N) / Real(N);
+        Real fy = Real((i*104729) % N) / Real(N);
+        Real fz = Real(i) / Real(N);
+        x[i] = lo[0] + fx*(hi[0]-lo[0]);
+        y[i] = lo[1] + fy*(hi[1]-lo[1]);
+        z[i] = lo[2] + fz*(hi[2]-lo[2]);
+    }
+
+    Vector<double> r_scalar(N), r_batch(N);
+
+    double t0 = amrex::second();
+    for (int i = 0; i < N; ++i) {
+        r_scalar[i] = exe(x[i], y[i], z[i]);
+    }
+    double t1 = amrex::second();
+    exe.evalBatch(N, r_batch.data(), x.data(), y.data(), z.data());
+    double t2 = amrex::second();
+
+    int nfail = 0;
+    for (int i = 0; i < N; ++i) {
+        Real abserror = std::abs(r_scalar[i]-r_batch[i]);
+        Real relerror = abserror / (1.e-50 + std::max(std::abs(r_scalar[i]),std::abs(r_batch[i])));
+        if (relerror > reltol) { ++nfail; }
+    }
+
+    amrex::Print() << "    scalar: " << t1-t0 << " s, batch: " << t2-t1 << " s";
+    if (nfail > 0) {
+        amrex::Print() << "    failed " << nfail << " times\n";
+        return 1;
+    } else {
+        amrex::Print() << "    pass\n";
+        return 0;
+    }
+}
+
 int main (int argc, char* argv[])
 {
     amrex::Initialize(argc, argv);
@@ -369,6 +424,48 @@ int main (int argc, char* argv[])
         amrex::Print() << "\n";
     }
 
+    {
+        int nerror = 0;
+        constexpr int N = 1000000;
+        nerror += test_batch("if( ((z-zc)*(z-zc)+(y-yc)*(y-yc)+(x-xc)*(x-xc))^(0.5) < (r_star-dR), 0.0, if(((z-zc)*(z-zc)+(y-yc)*(y-yc)+(x-xc)*(x-xc))^(0.5) <= r_star, dens, 0.0))",
+                             {{"xc", 0.1}, {"yc", -1.0}, {"zc", 0.2}, {"r_star", 0.73}, {"dR", 0.57}, {"dens", 12.}},
+                             {-1., -1., -1.}, {1., 1., 1.}, N, 1.e-15);
+        nerror += test_batch("( ((( (z-zc)*(z-zc) + (y-yc)*(y-yc) + (x-xc)*(x-xc) )^(0.5))<=r_star) * ((( (z-zc)*(z-zc) + (y-yc)*(y-yc) + (x-xc)*(x-xc) )^(0.5))>=(r_star-dR)) )*dens",
+                             {{"xc", 0.1}, {"yc", -1.0}, {"zc", 0.2}, {"r_star", 0.73}, {"dR", 0.57}, {"dens", 12.}},
+                             {-1., -1., -1.}, {1., 1., 1.}, N, 1.e-15);
+        nerror += test_batch("r2=(x-xc)**2+(y-yc)**2; a*r2**3 - b*(x-xc)*(y-yc)/(1+r2) + c*z**2*(x+y)",
+                             {{"xc", 0.1}, {"yc", -0.2}, {"a", 1.5}, {"b", 0.25}, {"c", -3.}},
+                             {-1., -1., -1.}, {1., 1., 1.}, N, 1.e-15);
+        nerror += test_batch("epsilon/kp*2*x/w0**2*exp(-(x**2+y**2)/w0**2)*sin(k0*z)",
+                             {{"epsilon", 0.01}, {"kp", 3.5}, {"w0", 5.e-6}, {"k0", 3.e5}},
+                             {0.e-6, 0.0, -20.e-6}, {20.e-6, 1.e-10, 20.e-6}, N, 1.e-15);
+
+        if (nerror > 0) {
+            amrex::Print() << nerror << " batch tests failed\n";
+            amrex::Abort();
+        } else {
+            amrex::Print() << "All batch tests passed\n";
+        }
+        amrex::Print() << "\n";
+    }
+
+    {
+        // x^0.5 is not sqrt(x) for -0 and -inf
+        amrex::Print() << "Testing \"x^0.5\" at -0 and -inf\n";
+        Parser parser("x^0.5");
+        parser.registerVariables({"x"});
+        auto const exe = parser.compileHost<1>();
+        for (double x : {-0.0, -std::numeric_limits<double>::infinity()}) {
+            const double r = exe(x);
+            const double expected = std::pow(x, 0.5);
+            AMREX_ALWAYS_ASSERT(r == expected && std::signbit(r) == std::signbit(expected));
+            double rb;
+            exe.evalBatch(1, &rb, &x);
+            AMREX_ALWAYS_ASSERT(rb == expected && std::signbit(rb) == std::signbit(expected));
+        }
+        amrex::Print() << "\n";
+    }
+
     {
         int count = 0;
         int x = 11;
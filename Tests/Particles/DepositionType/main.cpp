@@ -0,0 +1,108 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleMesh.H>
+#include <AMReX_ParticleInterpolators.H>
+
+using namespace amrex;
+
+// Deposit the particle mass with ParticleToMesh, which uses the deposition
+// type selected by particles.deposition_type, and compare the result with a
+// deposition done one particle after another.  Run with more than one
+// thread, all the deposition types must give the same density up to
+// roundoff.
+
+namespace {
+
+using PC = ParticleContainer<1, 0>;
+
+struct DepositMass
+{
+    GpuArray<Real,AMREX_SPACEDIM> plo;
+    GpuArray<Real,AMREX_SPACEDIM> dxi;
+
+    AMREX_GPU_HOST_DEVICE
+    void operator() (const PC::ParticleType& p, Array4<Real> const& rho) const noexcept
+    {
+        ParticleInterpolator::Linear interp(p, plo, dxi);
+        interp.ParticleToMesh(p, rho, 0, 0, 1,
+            [=] AMREX_GPU_HOST_DEVICE (const PC::ParticleType& part, int comp)
+            {
+                return part.rdata(comp);
+            });
+    }
+};
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 32;
+        int nppc = 4;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("nppc", nppc);
+        }
+
+        Geometry geom(Box(IntVect(0), IntVect(n_cell-1)),
+                      RealBox({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)}),
+                      CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        PC pc(geom, dm, ba);
+        const Long num_particles = Long(nppc) * geom.Domain().numPts();
+        PC::ParticleInitData pdata = {{Real(2.0)}, {}, {}, {}};
+        pc.InitRandom(num_particles, 451, pdata, true);
+
+        const DepositMass deposit{geom.ProbLoArray(), geom.InvCellSizeArray()};
+
+        MultiFab rho(ba, dm, 1, 1);
+        ParticleToMesh(pc, rho, 0,
+            [=] AMREX_GPU_DEVICE (const PC::ParticleType& p, Array4<Real> const& a)
+            {
+                deposit(p, a);
+            });
+
+        MultiFab rho_ref(ba, dm, 1, 1);
+        rho_ref.setVal(0.0);
+        for (PC::ParConstIterType pti(pc, 0); pti.isValid(); ++pti)
+        {
+            const auto& aos = pti.GetArrayOfStructs();
+            Gpu::HostVector<PC::ParticleType> host_particles(aos.size());
+            Gpu::copyAsync(Gpu::deviceToHost, aos.begin(), aos.end(), host_particles.begin());
+            Gpu::streamSynchronize();
+
+            FArrayBox host_fab(rho_ref[pti].box(), 1, The_Pinned_Arena());
+            host_fab.setVal<RunOn::Host>(0.0);
+            auto const& a = host_fab.array();
+            for (auto const& p : host_particles) {
+                deposit(p, a);
+            }
+            // With tiling, several tiles deposit into the same fab
+            rho_ref[pti].plus<RunOn::Device>(host_fab, host_fab.box(), 0, 0, 1);
+            Gpu::streamSynchronize();
+        }
+        rho_ref.SumBoundary(geom.periodicity());
+
+        const Real total_mass = rho.sum(0);
+        MultiFab::Subtract(rho, rho_ref, 0, 0, 1, 0);
+        const Real diff = rho.norminf(0) / rho_ref.norminf(0);
+
+        amrex::Print() << "Deposition type " << PC::DepositionType()
+                       << " with " << OpenMP::get_max_threads() << " threads: total mass "
+                       << total_mass << ", relative difference " << diff << "\n";
+
+        const Real expected_mass = Real(2.0) * static_cast<Real>(num_particles);
+        AMREX_ALWAYS_ASSERT(std::abs(total_mass - expected_mass) < Real(1.e-10)*expected_mass);
+        AMREX_ALWAYS_ASSERT(diff < Real(1.e-12));
+    }
+    amrex::Finalize();
+}
@@ -229,6 +229,93 @@ void MDParticleContainer::moveParticles(amrex::ParticleReal dx)
     }
 }
 
+void MDParticleContainer::displaceParticles(amrex::ParticleReal max_dx)
+{
+    BL_PROFILE("MDParticleContainer::displaceParticles");
+
+    const int lev = 0;
+
+    for (MyParIter pti(*this, lev); pti.isValid(); ++pti)
+    {
+        auto& aos = pti.GetArrayOfStructs();
+        ParticleType* pstruct = aos().dataPtr();
+        const int np = pti.numParticles();
+
+        amrex::ParallelFor( np, [=] AMREX_GPU_DEVICE (int i) noexcept
+        {
+            ParticleType& p = pstruct[i];
+            const auto id = static_cast<ParticleReal>(p.id());
+            const ParticleReal len = max_dx*ParticleReal(0.25)*ParticleReal(1 + p.id() % 4);
+#if (AMREX_SPACEDIM == 1)
+            amrex::ignore_unused(id);
+            p.pos(0) += (p.id() % 2 == 0) ? len : -len;
+#elif (AMREX_SPACEDIM == 2)
+            const ParticleReal theta = ParticleReal(0.7)*id;
+            p.pos(0) += len*std::cos(theta);
+            p.pos(1) += len*std::sin(theta);
+#else
+            const ParticleReal theta = ParticleReal(0.7)*id;
+            const ParticleReal phi = ParticleReal(1.9)*id;
+            p.pos(0) += len*std::sin(phi)*std::cos(theta);
+            p.pos(1) += len*std::sin(phi)*std::sin(theta);
+            p.pos(2) += len*std::cos(phi);
+#endif
+        });
+    }
+}
+
+std::map<MDParticleContainer::ParticleKey, std::vector<MDParticleContainer::ParticleKey> >
+MDParticleContainer::neighborsWithin(amrex::Real r)
+{
+    BL_PROFILE("MDParticleContainer::neighborsWithin");
+
+    const int lev = 0;
+    auto& plev  = GetParticles(lev);
+
+    std::map<ParticleKey, std::vector<ParticleKey> > nbors;
+
+    for (MFIter mfi = MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        auto index = std::make_pair(mfi.index(), mfi.LocalTileIndex());
+
+        auto& aos = plev[index].GetArrayOfStructs();
+        const int np       = aos.numParticles();
+        const int np_total = aos.numTotalParticles();
+
+        amrex::Gpu::HostVector<ParticleType> h_pstruct(np_total);
+        Gpu::copy(Gpu::deviceToHost, aos().dataPtr(), aos().dataPtr() + np_total, h_pstruct.begin());
+
+        auto& d_counts = m_neighbor_list[lev][index].GetCounts();
+        Gpu::HostVector<unsigned int> h_counts(d_counts.size());
+        Gpu::copy(Gpu::deviceToHost, d_counts.begin(), d_counts.end(), h_counts.begin());
+
+        auto& d_list = m_neighbor_list[lev][index].GetList();
+        Gpu::HostVector<unsigned int> h_list(d_list.size());
+        Gpu::copy(Gpu::deviceToHost, d_list.begin(), d_list.end(), h_list.begin());
+
+        unsigned start = 0;
+        for (int i = 0; i < np; ++i)
+        {
+            const ParticleType& p1 = h_pstruct[i];
+            auto& v = nbors[ParticleKey(p1.id(), p1.cpu())];
+            for (unsigned n = start; n < start + h_counts[i]; ++n)
+            {
+                const ParticleType& p2 = h_pstruct[h_list[n]];
+                AMREX_D_TERM(Real dx = p1.pos(0) - p2.pos(0);,
+                             Real dy = p1.pos(1) - p2.pos(1);,
+                             Real dz = p1.pos(2) - p2.pos(2);)
+                if (AMREX_D_TERM(dx*dx, + dy*dy, + dz*dz) <= r*r) {
+                    v.emplace_back(p2.id(), p2.cpu());
+                }
+            }
+            std::sort(v.begin(), v.end());
+            start += h_counts[i];
+        }
+    }
+
+    return nbors;
+}
+
 void MDParticleContainer::writeParticles(int n)
 {
     BL_PROFILE("MDParticleContainer::writeParticles");
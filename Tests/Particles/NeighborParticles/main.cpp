@@ -25,6 +25,8 @@ void testNeighborParticles();
 
 void testNeighborList();
 
+void testVerletList();
+
 int main (int argc, char* argv[])
 {
     amrex::Initialize(argc,argv);
@@ -35,6 +37,9 @@ int main (int argc, char* argv[])
     amrex::PrintToFile("neighbor_test") << "Running neighbor list test \n";
     testNeighborList();
 
+    amrex::PrintToFile("neighbor_test") << "Running Verlet list test \n";
+    testVerletList();
+
     amrex::Finalize();
 }
 
@@ -220,3 +225,74 @@ void testNeighborList ()
         pc.WritePlotFile("NeighborParticles_plt00001", "neighbors");
     }
 }
+
+void testVerletList ()
+{
+    BL_PROFILE("testVerletList");
+    TestParams params;
+    get_test_params(params, "verlet_list");
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++)
+    {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, params.size[n]);
+    }
+
+    IntVect domain_lo(AMREX_D_DECL(0, 0, 0));
+    IntVect domain_hi(AMREX_D_DECL(params.size[0]-1,params.size[1]-1,params.size[2]-1));
+    const Box domain(domain_lo, domain_hi);
+
+    int coord = 0;
+    int is_per[] = {AMREX_D_DECL(params.is_periodic,
+                                 params.is_periodic,
+                                 params.is_periodic)};
+    Geometry geom(domain, &real_box, coord, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(params.max_grid_size);
+    DistributionMapping dm(ba);
+
+    // The particles are on a lattice of spacing 1, and interact out to a
+    // cutoff of 1.  The list is built out to the cutoff plus the skin, which
+    // the two neighbor cells cover.
+    const Real cutoff = 1.0;
+    const Real skin = 0.3;
+    const int ncells = 2;
+    MDParticleContainer pc(geom, dm, ba, ncells);
+
+    IntVect nppc(params.num_ppc);
+
+    pc.InitParticles(nppc, 1.0, 0.0);
+
+    pc.setVerletSkin(skin);
+
+    // Every step moves each particle by 0.015 to 0.06 in its own direction,
+    // so the particles that move farthest pass half the skin every third
+    // step, and the list should be rebuilt then.
+    const ParticleReal max_dx = 0.06;
+    const int nsteps = 7;
+    int num_rebuilds = 0;
+    for (int step = 0; step < nsteps; ++step)
+    {
+        if (pc.updateNeighborList(CheckPairWithin{cutoff+skin})) { ++num_rebuilds; }
+
+        if (params.check_answer) {
+            // The pairs within the cutoff must be the same in the list that
+            // may have been kept from an earlier step and in a fresh list.
+            MDParticleContainer fresh(geom, dm, ba, ncells);
+            fresh.copyParticles(pc);
+            fresh.fillNeighbors();
+            fresh.buildNeighborList(CheckPairWithin{cutoff});
+            AMREX_ALWAYS_ASSERT(pc.neighborsWithin(cutoff) == fresh.neighborsWithin(cutoff));
+        }
+
+        pc.displaceParticles(max_dx);
+    }
+
+    amrex::PrintToFile("neighbor_test") << "Rebuilt the Verlet list " << num_rebuilds
+                                        << " times in " << nsteps << " steps, should be 3 \n";
+    if (params.check_answer) {
+        AMREX_ALWAYS_ASSERT(num_rebuilds == 3);
+    }
+}
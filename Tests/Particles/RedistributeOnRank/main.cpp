@@ -0,0 +1,238 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+// Move all the particles to another box that is owned by the same rank, and
+// redistribute them globally and locally, with the CPU algorithm and, in GPU
+// builds, with the GPU algorithm.  No particle leaves its rank, so every rank
+// must end up with the particles it started with.  The on-rank copies that
+// RedistributeGPU does when no particle leaves any rank are also tested
+// directly, so that they are covered by CPU builds.
+
+namespace {
+
+class PC
+    : public ParticleContainer<0, 0>
+{
+public:
+    using ParticleContainer<0, 0>::ParticleContainer;
+    using ParticleContainer<0, 0>::defineBufferMap;
+};
+
+void init_particles (PC& pc)
+{
+    const int lev = 0;
+    const auto dx = pc.Geom(lev).CellSizeArray();
+    const auto plo = pc.Geom(lev).ProbLoArray();
+
+    for (MFIter mfi = pc.MakeMFIter(lev); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+
+        Gpu::HostVector<PC::ParticleType> host_particles;
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            PC::ParticleType p;
+            p.id()  = PC::ParticleType::NextID();
+            p.cpu() = ParallelDescriptor::MyProc();
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                p.pos(idim) = static_cast<ParticleReal>(plo[idim] + (iv[idim]+Real(0.5))*dx[idim]);
+            }
+            host_particles.push_back(p);
+        }
+
+        auto& ptile = pc.DefineAndReturnParticleTile(lev, mfi.index(), mfi.LocalTileIndex());
+        ptile.resize(host_particles.size());
+        Gpu::copyAsync(Gpu::hostToDevice, host_particles.begin(), host_particles.end(),
+                       ptile.GetArrayOfStructs().begin());
+        Gpu::streamSynchronize();
+    }
+}
+
+// Boxes are owned in pairs along x, so moving a particle by one box size in
+// x towards the other box of its pair keeps it on its rank.
+void move_particles (PC& pc, int max_grid_size)
+{
+    const int lev = 0;
+    const auto dx = pc.Geom(lev).CellSizeArray();
+    const auto plo = pc.Geom(lev).ProbLoArray();
+
+    for (PC::ParIterType pti(pc, lev); pti.isValid(); ++pti)
+    {
+        auto* pstruct = pti.GetArrayOfStructs()().data();
+        ParallelFor(pti.numParticles(), [=] AMREX_GPU_DEVICE (int i) noexcept
+        {
+            auto& p = pstruct[i];
+            const int ix = static_cast<int>((p.pos(0) - plo[0]) / dx[0]);
+            const int shift = ((ix/max_grid_size) % 2 == 0) ? max_grid_size : -max_grid_size;
+            p.pos(0) += static_cast<ParticleReal>(shift*dx[0]);
+        });
+    }
+}
+
+Long unique_id (PC::ParticleType const& p)
+{
+    return p.id()*ParallelDescriptor::NProcs() + p.cpu();
+}
+
+Vector<Long> local_ids (PC const& pc)
+{
+    Vector<Long> ids;
+    for (PC::ParConstIterType pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const auto& aos = pti.GetArrayOfStructs();
+        Gpu::HostVector<PC::ParticleType> host_particles(aos.size());
+        Gpu::copyAsync(Gpu::deviceToHost, aos.begin(), aos.end(), host_particles.begin());
+        Gpu::streamSynchronize();
+        for (auto const& p : host_particles) {
+            ids.push_back(unique_id(p));
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Move the particles to the boxes they are in with gatherLocalCopies and
+// scatterLocalCopies.  The particles whose id is a multiple of drop_every
+// get a negative destination box and must be removed.  Returns the ids of
+// the particles that are kept.
+Vector<Long> redistribute_local_copies (PC& pc, int drop_every)
+{
+    const int lev = 0;
+    const auto& ba = pc.ParticleBoxArray(lev);
+    const auto plo = pc.Geom(lev).ProbLoArray();
+    const auto dxi = pc.Geom(lev).InvCellSizeArray();
+    const Box domain = pc.Geom(lev).Domain();
+
+    pc.defineBufferMap();
+
+    Vector<Long> kept;
+    ParticleCopyOp op;
+    op.setNumLevels(1);
+    for (auto& kv : pc.GetParticles(lev))
+    {
+        const int gid = kv.first.first;
+        const auto& aos = kv.second.GetArrayOfStructs();
+        const auto np = static_cast<int>(aos.size());
+        Gpu::HostVector<PC::ParticleType> host_particles(np);
+        Gpu::copyAsync(Gpu::deviceToHost, aos.begin(), aos.end(), host_particles.begin());
+        Gpu::streamSynchronize();
+
+        Gpu::HostVector<int> boxes(np), levs(np, lev), src_indices(np);
+        Gpu::HostVector<IntVect> periodic_shift(np, IntVect(0));
+        for (int i = 0; i < np; ++i)
+        {
+            const auto& p = host_particles[i];
+            const IntVect iv = getParticleCell(p, plo, dxi, domain);
+            const auto isects = ba.intersections(Box(iv,iv));
+            AMREX_ALWAYS_ASSERT(isects.size() == 1);
+            if (p.id() % drop_every == 0) {
+                boxes[i] = -1;
+            } else {
+                boxes[i] = isects[0].first;
+                AMREX_ALWAYS_ASSERT(pc.ParticleDistributionMap(lev)[boxes[i]] ==
+                                    ParallelDescriptor::MyProc());
+                kept.push_back(unique_id(p));
+            }
+            src_indices[i] = i;
+        }
+
+        op.resize(gid, lev, np);
+        Gpu::copyAsync(Gpu::hostToDevice, boxes.begin(), boxes.end(),
+                       op.m_boxes[lev][gid].begin());
+        Gpu::copyAsync(Gpu::hostToDevice, levs.begin(), levs.end(),
+                       op.m_levels[lev][gid].begin());
+        Gpu::copyAsync(Gpu::hostToDevice, src_indices.begin(), src_indices.end(),
+                       op.m_src_indices[lev][gid].begin());
+        Gpu::copyAsync(Gpu::hostToDevice, periodic_shift.begin(), periodic_shift.end(),
+                       op.m_periodic_shift[lev][gid].begin());
+        Gpu::streamSynchronize();
+    }
+
+    AMREX_ALWAYS_ASSERT(allCopiesAreLocal(pc, op));
+
+    Vector<std::map<int, PC::ParticleTileType> > moved;
+    gatherLocalCopies(pc, op, moved);
+    for (auto& kv : pc.GetParticles(lev)) {
+        kv.second.resize(0);
+    }
+    scatterLocalCopies(pc, op, moved);
+
+    std::sort(kept.begin(), kept.end());
+    return kept;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        int n_cell = 48;
+        int max_grid_size = 8;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+        }
+        AMREX_ALWAYS_ASSERT(n_cell % (2*max_grid_size) == 0);
+
+        Geometry geom(Box(IntVect(0), IntVect(n_cell-1)),
+                      RealBox({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)}),
+                      CoordSys::cartesian, {AMREX_D_DECL(1,1,1)});
+        BoxArray ba(geom.Domain());
+        ba.maxSize(max_grid_size);
+
+        Vector<int> pmap(ba.size());
+        for (int i = 0; i < static_cast<int>(ba.size()); ++i) {
+            const int pair = ba[i].smallEnd(0) / (2*max_grid_size);
+            pmap[i] = pair % ParallelDescriptor::NProcs();
+        }
+        DistributionMapping dm(std::move(pmap));
+
+        PC pc(geom, dm, ba);
+        init_particles(pc);
+
+        const Long np_total = pc.TotalNumberOfParticles();
+        const Vector<Long> ids = local_ids(pc);
+
+        Vector<bool> gpu_algorithms{false};
+#ifdef AMREX_USE_GPU
+        gpu_algorithms.push_back(true);
+#endif
+
+        // For a local redistribute, the particles move by up to local cells
+        for (int local : {0, max_grid_size})
+        {
+            for (bool gpu_algorithm : gpu_algorithms)
+            {
+                move_particles(pc, max_grid_size);
+                if (gpu_algorithm) {
+                    pc.RedistributeGPU(0, -1, 0, local);
+                } else {
+                    pc.RedistributeCPU(0, -1, 0, local);
+                }
+
+                amrex::Print() << "Redistribute" << (gpu_algorithm ? "GPU" : "CPU")
+                               << (local ? " local" : " global") << ": "
+                               << pc.TotalNumberOfParticles() << " particles\n";
+
+                AMREX_ALWAYS_ASSERT(pc.OK());
+                AMREX_ALWAYS_ASSERT(pc.TotalNumberOfParticles() == np_total);
+                AMREX_ALWAYS_ASSERT(local_ids(pc) == ids);
+            }
+        }
+
+        move_particles(pc, max_grid_size);
+        const Vector<Long> kept = redistribute_local_copies(pc, 7);
+        amrex::Print() << "Local copies: " << pc.TotalNumberOfParticles() << " particles\n";
+        AMREX_ALWAYS_ASSERT(pc.OK());
+        AMREX_ALWAYS_ASSERT(local_ids(pc) == kept);
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,177 @@
+#include <AMReX.H>
+#include <AMReX_AsyncOut.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include <memory>
+
+using namespace amrex;
+
+void test_vismf_compress ();
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv,true,MPI_COMM_WORLD,[] ()
+    {
+        // ---- also test VisMF::AsyncWrite
+        ParmParse pp("amrex");
+        int async_out = 1;
+        pp.queryAdd("async_out", async_out);
+    });
+    test_vismf_compress();
+    amrex::Finalize();
+}
+
+namespace {
+    Real max_diff (MultiFab const& a, MultiFab const& b)
+    {
+        MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrowVect());
+        MultiFab::Copy(d, a, 0, 0, a.nComp(), a.nGrowVect());
+        MultiFab::Subtract(d, b, 0, 0, a.nComp(), a.nGrowVect());
+        return d.norm0(0, a.nComp(), a.nGrowVect());
+    }
+
+    Long file_bytes (std::string const& mf_name, int nfiles)
+    {
+        Long nbytes = 0;
+        if (ParallelDescriptor::IOProcessor()) {
+            for (int i = 0; i < nfiles; ++i) {
+                std::ifstream ifs(mf_name + "_D_" + amrex::Concatenate("",i,5),
+                                  std::ios::binary | std::ios::ate);
+                if (ifs.good()) { nbytes += static_cast<Long>(ifs.tellg()); }
+            }
+        }
+        ParallelDescriptor::ReduceLongMax(nbytes);
+        return nbytes;
+    }
+}
+
+void test_vismf_compress ()
+{
+    int n_cell = 64;
+    int max_grid_size = 32;
+    Real tolerance = 1.e-6;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("tolerance", tolerance);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    // A smooth component, a constant one and one that is noise.
+    const int ncomp = 3;
+    MultiFab mf(ba, dm, ncomp, 1);
+    const Real dx = Real(1.0)/Real(n_cell);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& a = mf.array(mfi);
+        amrex::ParallelForRNG(mfi.fabbox(),
+        [=] AMREX_GPU_DEVICE (int i, int j, int k, RandomEngine const& engine) noexcept
+        {
+            const Real x = (Real(i)+Real(0.5))*dx;
+            const Real y = (Real(j)+Real(0.5))*dx;
+            const Real z = (Real(k)+Real(0.5))*dx;
+            a(i,j,k,0) = std::sin(Real(6.0)*x) * std::cos(Real(4.0)*y) + z*z;
+            a(i,j,k,1) = Real(1.5);
+            a(i,j,k,2) = amrex::Random(engine);
+        });
+    }
+
+    UtilCreateCleanDirectory("vismfcompress", true);
+
+    const auto old_version = VisMF::GetHeaderVersion();
+
+    VisMF::SetHeaderVersion(VisMF::Header::NoFabHeader_v1);
+    VisMF::Write(mf, "vismfcompress/raw");
+
+    // ---- lossless
+    VisMF::SetHeaderVersion(VisMF::Header::Compressed_v1);
+    VisMF::SetCompressionTolerance(0.0);
+    VisMF::Write(mf, "vismfcompress/lossless");
+    {
+        MultiFab mf2(ba, dm, ncomp, 1);
+        VisMF::Read(mf2, "vismfcompress/lossless");
+        AMREX_ALWAYS_ASSERT(max_diff(mf, mf2) == Real(0.0));
+
+        // Read a new MultiFab with the BoxArray on disk.
+        MultiFab mf3;
+        VisMF::Read(mf3, "vismfcompress/lossless");
+        AMREX_ALWAYS_ASSERT(mf3.boxArray() == ba && mf3.nGrowVect() == mf.nGrowVect());
+        MultiFab mf4(ba, mf3.DistributionMap(), ncomp, 0);
+        MultiFab mf5(ba, mf3.DistributionMap(), ncomp, 0);
+        mf4.ParallelCopy(mf, 0, 0, ncomp);
+        MultiFab::Copy(mf5, mf3, 0, 0, ncomp, 0);
+        AMREX_ALWAYS_ASSERT(max_diff(mf4, mf5) == Real(0.0));
+    }
+
+    // ---- single component reads as done by PlotFileData
+    {
+        VisMF vismf("vismfcompress/lossless");
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            for (int icomp = 0; icomp < ncomp; ++icomp) {
+                std::unique_ptr<FArrayBox> fab(vismf.readFAB(mfi.index(), icomp));
+                auto const& a = fab->const_array();
+                auto const& b = mf.const_array(mfi, icomp);
+                Real err = 0;
+                amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k)
+                {
+                    err = std::max(err, std::abs(a(i,j,k)-b(i,j,k)));
+                });
+                AMREX_ALWAYS_ASSERT(err == Real(0.0));
+            }
+        }
+    }
+
+    // ---- error bounded lossy
+    VisMF::SetCompressionTolerance(tolerance);
+    VisMF::Write(mf, "vismfcompress/lossy");
+    {
+        MultiFab mf2(ba, dm, ncomp, 1);
+        VisMF::Read(mf2, "vismfcompress/lossy");
+        Real err = max_diff(mf, mf2);
+        amrex::Print() << "Lossy max error = " << err << ", tolerance = " << tolerance << "\n";
+        AMREX_ALWAYS_ASSERT(err <= tolerance);
+    }
+
+    const int nfiles = VisMF::GetNOutFiles();
+    const Long raw_bytes = file_bytes("vismfcompress/raw", nfiles);
+    amrex::Print() << "Bytes written: raw " << raw_bytes
+                   << ", lossless " << file_bytes("vismfcompress/lossless", nfiles)
+                   << ", lossy " << file_bytes("vismfcompress/lossy", nfiles) << "\n";
+
+    // ---- AsyncWrite compresses too, with and without the ghost cells
+    if (AsyncOut::UseAsyncOut()) {
+        VisMF::SetCompressionTolerance(0.0);
+        VisMF::AsyncWrite(mf, "vismfcompress/async_lossless");
+        VisMF::SetCompressionTolerance(tolerance);
+        VisMF::AsyncWrite(mf, "vismfcompress/async_lossy", true);
+        AsyncOut::Finish();
+
+        MultiFab mf2(ba, dm, ncomp, 1);
+        VisMF::Read(mf2, "vismfcompress/async_lossless");
+        AMREX_ALWAYS_ASSERT(max_diff(mf, mf2) == Real(0.0));
+
+        MultiFab mf3(ba, dm, ncomp, 0);
+        MultiFab mf4(ba, dm, ncomp, 0);
+        MultiFab::Copy(mf3, mf, 0, 0, ncomp, 0);
+        VisMF::Read(mf4, "vismfcompress/async_lossy");
+        Real err = max_diff(mf3, mf4);
+        AMREX_ALWAYS_ASSERT(err <= tolerance);
+
+        const int async_nfiles = ParallelDescriptor::NProcs();
+        const Long async_bytes = file_bytes("vismfcompress/async_lossless", async_nfiles);
+        amrex::Print() << "AsyncWrite lossy max error = " << err
+                       << ", lossless bytes written " << async_bytes << "\n";
+        AMREX_ALWAYS_ASSERT(async_bytes < raw_bytes);
+    }
+
+    VisMF::SetCompressionTolerance(0.0);
+    VisMF::SetHeaderVersion(old_version);
+}
@@ -284,6 +284,9 @@ print_option(AMReX_FORTRAN_INTERFACES)
 option( AMReX_LINEAR_SOLVERS  "Build AMReX Linear solvers" ON )
 print_option( AMReX_LINEAR_SOLVERS )
 
+option( AMReX_FFT "Build AMReX FFT" ON )
+print_option( AMReX_FFT )
+
 cmake_dependent_option( AMReX_AMRDATA "Build data services" OFF
    "AMReX_FORTRAN" OFF )
 print_option( AMReX_AMRDATA )
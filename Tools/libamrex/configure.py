@@ -73,6 +73,10 @@ def configure(argv):
                         help="Enable AMReX embedded boundary capability [default=no]",
                         choices=["yes","no"],
                         default="no")
+    parser.add_argument("--enable-fft",
+                        help="Enable AMReX FFT [default=no]",
+                        choices=["yes","no"],
+                        default="no")
     parser.add_argument("--single-precision",
                         help="Define amrex::Real as float [default=no (i.e., double)]",
                         choices=["yes","no"],
@@ -147,6 +151,7 @@ def configure(argv):
     f.write("USE_HYPRE = {}\n".format("TRUE" if args.enable_hypre == "yes" else "FALSE"))
     f.write("USE_PETSC = {}\n".format("TRUE" if args.enable_petsc == "yes" else "FALSE"))
     f.write("USE_EB = {}\n".format("TRUE" if args.enable_eb == "yes" else "FALSE"))
+    f.write("USE_FFT = {}\n".format("TRUE" if args.enable_fft == "yes" else "FALSE"))
     f.write("PRECISION = {}\n".format("FLOAT" if args.single_precision == "yes" else "DOUBLE"))
     f.write("USE_SINGLE_PRECISION_PARTICLES = {}\n".format("TRUE" if args.single_precision_particles == "yes" else "FALSE"))
     f.write("AMREX_XSDK = {}\n".format("TRUE" if args.enable_xsdk_defaults == "yes" else "FALSE"))